@@ -52,6 +52,9 @@ enum {
     TE_FLAG_PURE = 32
 };
 
+typedef struct te_program te_program;
+
+
 typedef struct te_variable {
     const char *name;
     const void *address;
@@ -72,6 +75,29 @@ te_expr *te_compile(const char *expression, const te_variable *variables, int va
 /* Evaluates the expression. */
 double te_eval(const te_expr *n);
 
+/* Lowers a compiled expression into a flat postfix program. */
+/* The program shares bound variables and closure contexts with the */
+/* expression, which may be freed afterwards. Returns NULL on error. */
+te_program *te_compile_program(const te_expr *n);
+
+/* Evaluates the program. Same result as te_eval on the source tree. */
+double te_eval_program(const te_program *p);
+
+/* Frees the program. Safe to call on NULL pointers. */
+void te_free_program(te_program *p);
+
+/* Evaluates the program over blocks of n values: each variable is read as */
+/* n consecutive doubles starting at its bound address, and the results are */
+/* written to out. work must hold te_program_workspace(p, n) doubles. */
+void te_eval_program_block(const te_program *p, int n, double *out, double *work);
+
+/* Number of doubles of scratch te_eval_program_block needs for n values. */
+int te_program_workspace(const te_program *p, int n);
+
+/* Points every use of the variable bound at from to to instead. */
+/* Returns the number of operands changed. */
+int te_program_rebind(te_program *p, const double *from, const double *to);
+
 /* Prints debugging information on the syntax tree. */
 void te_print(const te_expr *n);
 
@@ -1,14 +1,47 @@
 #!/usr/bin/env python3 
 
+import sys
+
 from mako.template import Template
 
 SKIP_FUNCS = [
    'rando',
-   'airy_ai',
-   'airy_bi',
    'add',
 ]
 
+# functions without a signal-rate (psl~) kernel
+SIGNAL_SKIP_FUNCS = [
+   'rando',
+]
+
+# size of the argument array (MAX_ARGS in psl.c)
+MAX_ARGS = 6
+
+# default diagnostics level compiled into psl.c (PSL_VERBOSE), 0 for none;
+# override with `scripts/render.py --verbose N` or `make PSL_VERBOSE=N`
+VERBOSE = 0
+
+# call expressions for functions which are not a plain `gsl_<fullname>(...)`
+CALL_EXPRS = {
+   'add':         '{0} + {1}',
+}
+
+# functions taking a trailing gsl_mode_t, with the precision used when an
+# object has not chosen one (see the `precision` message)
+PREC_MODES = {
+   'airy_ai':        'GSL_PREC_APPROX',
+   'airy_bi':        'GSL_PREC_APPROX',
+   'airy_ai_deriv':  'GSL_PREC_DOUBLE',
+   'airy_bi_deriv':  'GSL_PREC_DOUBLE',
+   'ellint_kcomp':   'GSL_PREC_DOUBLE',
+   'ellint_ecomp':   'GSL_PREC_DOUBLE',
+   'ellint_pcomp':   'GSL_PREC_DOUBLE',
+   'ellint_f':       'GSL_PREC_DOUBLE',
+   'ellint_e':       'GSL_PREC_DOUBLE',
+   'ellint_p':       'GSL_PREC_DOUBLE',
+   'ellint_d':       'GSL_PREC_DOUBLE',
+}
+
 
 items = [
 
@@ -50,29 +83,234 @@ items = [
    (1,   'debye_2',     'sf_debye_2'),
    (1,   'debye_3',     'sf_debye_3'),
    (1,   'debye_4',     'sf_debye_4'),
+   (3,   'ellint_p',    'sf_ellint_P'),
+   (4,   'hyperg_2f1',  'sf_hyperg_2F1'),
+   (6,   'coupling_3j', 'sf_coupling_3j'),
+   (6,   'coupling_6j', 'sf_coupling_6j'),
 ]
 
 
+# vector-valued gsl_sf_*_array families: one call fills a whole sequence
+# (e.g. J_nmin(x) .. J_nmax(x) by recurrence) which is sent out as a list
+# or written to an array. The integer arguments come first.
+
+array_items = [
+
+   #name                  fullname                      int args          double args        size
+   ('bessel_jn_array',     'sf_bessel_Jn_array',         ('nmin', 'nmax'), ('x',),            'nmax - nmin + 1'),
+   ('bessel_yn_array',     'sf_bessel_Yn_array',         ('nmin', 'nmax'), ('x',),            'nmax - nmin + 1'),
+   ('bessel_in_array',     'sf_bessel_In_array',         ('nmin', 'nmax'), ('x',),            'nmax - nmin + 1'),
+   ('bessel_in_scaled_array', 'sf_bessel_In_scaled_array', ('nmin', 'nmax'), ('x',),          'nmax - nmin + 1'),
+   ('bessel_kn_array',     'sf_bessel_Kn_array',         ('nmin', 'nmax'), ('x',),            'nmax - nmin + 1'),
+   ('bessel_kn_scaled_array', 'sf_bessel_Kn_scaled_array', ('nmin', 'nmax'), ('x',),          'nmax - nmin + 1'),
+   ('bessel_jl_array',     'sf_bessel_jl_array',         ('lmax',),        ('x',),            'lmax + 1'),
+   ('bessel_yl_array',     'sf_bessel_yl_array',         ('lmax',),        ('x',),            'lmax + 1'),
+   ('bessel_il_scaled_array', 'sf_bessel_il_scaled_array', ('lmax',),      ('x',),            'lmax + 1'),
+   ('bessel_kl_scaled_array', 'sf_bessel_kl_scaled_array', ('lmax',),      ('x',),            'lmax + 1'),
+   ('legendre_pl_array',   'sf_legendre_Pl_array',       ('lmax',),        ('x',),            'lmax + 1'),
+   ('legendre_plm_array',  'sf_legendre_Plm_array',      ('lmax', 'm'),    ('x',),            'lmax - m + 1'),
+   ('legendre_h3d_array',  'sf_legendre_H3d_array',      ('lmax',),        ('lambda', 'eta'), 'lmax + 1'),
+   ('gegenpoly_array',     'sf_gegenpoly_array',         ('nmax',),        ('lambda', 'x'),   'nmax + 1'),
+   ('hermite_array',       'sf_hermite_array',           ('nmax',),        ('x',),            'nmax + 1'),
+   ('hermite_phys_array',  'sf_hermite_phys_array',      ('nmax',),        ('x',),            'nmax + 1'),
+   ('hermite_func_array',  'sf_hermite_func_array',      ('nmax',),        ('x',),            'nmax + 1'),
+]
+
 
-# def hash(str):
-#    h = 0
-#    for c in str:
-#        h += ord(c)
-#    return h
+# further gsl_sf_* functions which are only available inside expressions
+# (symbol messages and [psl expr ...]), in addition to everything in `items`
 
-# def hash(str):
-#    h = 5381
-#    for c in str:
-#       h = ((h << 5) + h) + ord(c)
-#    return h
+expr_items = [
 
-def hash(str):
-   h = 0
-   for c in str:
-      h += (h << 1) + ord(c)
+   #nargs name                   fullname
+   (1,   'airy_ai_deriv',        'sf_airy_Ai_deriv'),
+   (1,   'airy_bi_deriv',        'sf_airy_Bi_deriv'),
+   (1,   'airy_zero_ai',         'sf_airy_zero_Ai'),
+   (1,   'airy_zero_bi',         'sf_airy_zero_Bi'),
+   (1,   'bessel_k0',            'sf_bessel_K0'),
+   (1,   'bessel_k1',            'sf_bessel_K1'),
+   (2,   'bessel_kn',            'sf_bessel_Kn'),
+   (1,   'bessel_i0_scaled',     'sf_bessel_I0_scaled'),
+   (1,   'bessel_i1_scaled',     'sf_bessel_I1_scaled'),
+   (2,   'bessel_in_scaled',     'sf_bessel_In_scaled'),
+   (1,   'bessel_k0_scaled',     'sf_bessel_K0_scaled'),
+   (1,   'bessel_k1_scaled',     'sf_bessel_K1_scaled'),
+   (2,   'bessel_kn_scaled',     'sf_bessel_Kn_scaled'),
+   (1,   'bessel_sj0',           'sf_bessel_j0'),
+   (1,   'bessel_sj1',           'sf_bessel_j1'),
+   (1,   'bessel_sj2',           'sf_bessel_j2'),
+   (2,   'bessel_sjl',           'sf_bessel_jl'),
+   (1,   'bessel_sy0',           'sf_bessel_y0'),
+   (1,   'bessel_sy1',           'sf_bessel_y1'),
+   (1,   'bessel_sy2',           'sf_bessel_y2'),
+   (2,   'bessel_syl',           'sf_bessel_yl'),
+   (2,   'bessel_jnu',           'sf_bessel_Jnu'),
+   (2,   'bessel_ynu',           'sf_bessel_Ynu'),
+   (2,   'bessel_inu',           'sf_bessel_Inu'),
+   (2,   'bessel_knu',           'sf_bessel_Knu'),
+   (2,   'bessel_lnknu',         'sf_bessel_lnKnu'),
+   (1,   'bessel_zero_j0',       'sf_bessel_zero_J0'),
+   (1,   'bessel_zero_j1',       'sf_bessel_zero_J1'),
+   (2,   'bessel_zero_jnu',      'sf_bessel_zero_Jnu'),
+   (1,   'debye_5',              'sf_debye_5'),
+   (1,   'debye_6',              'sf_debye_6'),
+   (1,   'dilog',                'sf_dilog'),
+   (1,   'ellint_kcomp',         'sf_ellint_Kcomp'),
+   (1,   'ellint_ecomp',         'sf_ellint_Ecomp'),
+   (2,   'ellint_pcomp',         'sf_ellint_Pcomp'),
+   (2,   'ellint_f',             'sf_ellint_F'),
+   (2,   'ellint_e',             'sf_ellint_E'),
+   (2,   'ellint_d',             'sf_ellint_D'),
+   (1,   'erf',                  'sf_erf'),
+   (1,   'erfc',                 'sf_erfc'),
+   (1,   'log_erfc',             'sf_log_erfc'),
+   (1,   'erf_z',                'sf_erf_Z'),
+   (1,   'erf_q',                'sf_erf_Q'),
+   (1,   'hazard',               'sf_hazard'),
+   (1,   'exprel',               'sf_exprel'),
+   (1,   'exprel_2',             'sf_exprel_2'),
+   (2,   'exprel_n',             'sf_exprel_n'),
+   (1,   'expint_e1',            'sf_expint_E1'),
+   (1,   'expint_e2',            'sf_expint_E2'),
+   (2,   'expint_en',            'sf_expint_En'),
+   (1,   'expint_ei',            'sf_expint_Ei'),
+   (1,   'expint_3',             'sf_expint_3'),
+   (1,   'shi',                  'sf_Shi'),
+   (1,   'chi',                  'sf_Chi'),
+   (1,   'si',                   'sf_Si'),
+   (1,   'ci',                   'sf_Ci'),
+   (1,   'atanint',              'sf_atanint'),
+   (1,   'fermi_dirac_m1',       'sf_fermi_dirac_m1'),
+   (1,   'fermi_dirac_0',        'sf_fermi_dirac_0'),
+   (1,   'fermi_dirac_1',        'sf_fermi_dirac_1'),
+   (1,   'fermi_dirac_2',        'sf_fermi_dirac_2'),
+   (2,   'fermi_dirac_int',      'sf_fermi_dirac_int'),
+   (1,   'fermi_dirac_mhalf',    'sf_fermi_dirac_mhalf'),
+   (1,   'fermi_dirac_half',     'sf_fermi_dirac_half'),
+   (1,   'fermi_dirac_3half',    'sf_fermi_dirac_3half'),
+   (1,   'gamma',                'sf_gamma'),
+   (1,   'lngamma',              'sf_lngamma'),
+   (1,   'gammastar',            'sf_gammastar'),
+   (1,   'gammainv',             'sf_gammainv'),
+   (2,   'taylorcoeff',          'sf_taylorcoeff'),
+   (1,   'fact',                 'sf_fact'),
+   (1,   'doublefact',           'sf_doublefact'),
+   (1,   'lnfact',               'sf_lnfact'),
+   (2,   'choose',               'sf_choose'),
+   (2,   'lnchoose',             'sf_lnchoose'),
+   (2,   'poch',                 'sf_poch'),
+   (2,   'lnpoch',               'sf_lnpoch'),
+   (2,   'gamma_inc',            'sf_gamma_inc'),
+   (2,   'gamma_inc_p',          'sf_gamma_inc_P'),
+   (2,   'gamma_inc_q',          'sf_gamma_inc_Q'),
+   (2,   'beta',                 'sf_beta'),
+   (2,   'lnbeta',               'sf_lnbeta'),
+   (3,   'beta_inc',             'sf_beta_inc'),
+   (2,   'gegenpoly_1',          'sf_gegenpoly_1'),
+   (2,   'gegenpoly_2',          'sf_gegenpoly_2'),
+   (2,   'gegenpoly_3',          'sf_gegenpoly_3'),
+   (3,   'gegenpoly_n',          'sf_gegenpoly_n'),
+   (2,   'hermite',              'sf_hermite'),
+   (2,   'hermite_func',         'sf_hermite_func'),
+   (2,   'hyperg_0f1',           'sf_hyperg_0F1'),
+   (3,   'hyperg_1f1',           'sf_hyperg_1F1'),
+   (3,   'hyperg_u',             'sf_hyperg_U'),
+   (3,   'hyperg_2f0',           'sf_hyperg_2F0'),
+   (1,   'lambert_w0',           'sf_lambert_W0'),
+   (1,   'lambert_wm1',          'sf_lambert_Wm1'),
+   (2,   'laguerre_1',           'sf_laguerre_1'),
+   (2,   'laguerre_2',           'sf_laguerre_2'),
+   (2,   'laguerre_3',           'sf_laguerre_3'),
+   (3,   'laguerre_n',           'sf_laguerre_n'),
+   (1,   'legendre_p1',          'sf_legendre_P1'),
+   (1,   'legendre_p2',          'sf_legendre_P2'),
+   (1,   'legendre_p3',          'sf_legendre_P3'),
+   (2,   'legendre_pl',          'sf_legendre_Pl'),
+   (1,   'legendre_q0',          'sf_legendre_Q0'),
+   (1,   'legendre_q1',          'sf_legendre_Q1'),
+   (2,   'legendre_ql',          'sf_legendre_Ql'),
+   (3,   'legendre_plm',         'sf_legendre_Plm'),
+   (3,   'legendre_sphplm',      'sf_legendre_sphPlm'),
+   (1,   'log_1plusx',           'sf_log_1plusx'),
+   (1,   'log_1plusx_mx',        'sf_log_1plusx_mx'),
+   (1,   'psi',                  'sf_psi'),
+   (1,   'psi_1piy',             'sf_psi_1piy'),
+   (1,   'psi_1',                'sf_psi_1'),
+   (2,   'psi_n',                'sf_psi_n'),
+   (1,   'synchrotron_1',        'sf_synchrotron_1'),
+   (1,   'synchrotron_2',        'sf_synchrotron_2'),
+   (1,   'transport_2',          'sf_transport_2'),
+   (1,   'transport_3',          'sf_transport_3'),
+   (1,   'transport_4',          'sf_transport_4'),
+   (1,   'transport_5',          'sf_transport_5'),
+   (1,   'sinc',                 'sf_sinc'),
+   (1,   'lnsinh',               'sf_lnsinh'),
+   (1,   'lncosh',               'sf_lncosh'),
+   (1,   'angle_restrict_symm',  'sf_angle_restrict_symm'),
+   (1,   'angle_restrict_pos',   'sf_angle_restrict_pos'),
+   (1,   'zeta',                 'sf_zeta'),
+   (1,   'zetam1',               'sf_zetam1'),
+   (2,   'hzeta',                'sf_hzeta'),
+   (1,   'eta',                  'sf_eta'),
+]
+
+
+
+# FNV-1a (32-bit) with a seed, must be kept in sync with psl_hash() in the
+# template. A seed of 0 is used to pick the bucket, the per-bucket seed
+# (displacement) to pick the final slot.
+def hash(str, seed=0):
+   h = (2166136261 ^ seed) & 0xffffffff
+   for c in str.encode():
+      h ^= c
+      h = (h * 16777619) & 0xffffffff
    return h
 
 
+class PerfectHash:
+   """minimal perfect hash over function names via hash-and-displace.
+
+   Every name ends up in exactly one of `len(funcs)` slots and the lookup
+   in C is `slots[hash(name, disp[hash(name, 0) % n]) % n]`.
+   """
+
+   MAX_SEED = 1 << 20
+
+   def __init__(self, funcs):
+      names = [f.name for f in funcs]
+      dups = sorted(set(n for n in names if names.count(n) > 1))
+      if dups:
+         raise SystemExit(f"render failed: duplicate function names: {dups}")
+
+      n = len(funcs)
+      buckets = [[] for _ in range(n)]
+      for f in funcs:
+         buckets[hash(f.name) % n].append(f)
+
+      self.size = n
+      self.disp = [0] * n
+      self.slots = [None] * n
+
+      # place the largest buckets first while there is most room left
+      for b in sorted(range(n), key=lambda i: -len(buckets[i])):
+         bucket = buckets[b]
+         if not bucket:
+            continue
+         for seed in range(1, self.MAX_SEED):
+            idx = [hash(f.name, seed) % n for f in bucket]
+            if len(set(idx)) == len(idx) and all(self.slots[i] is None for i in idx):
+               break
+         else:
+            raise SystemExit(f"render failed: no collision-free seed for "
+                             f"{[f.name for f in bucket]}")
+         self.disp[b] = seed
+         for i, f in zip(idx, bucket):
+            self.slots[i] = f
+
+      for f in funcs:
+         assert self.slots[hash(f.name, self.disp[hash(f.name) % n]) % n] is f
+
+
 class Func:
    def __init__(self, nargs, name, func_name):
       self.nargs = nargs
@@ -80,32 +318,51 @@ class Func:
       self.func_name = func_name
 
    @property
-   def hashed(self):
-      h = 0
-      for c in self.name:
-         h += (h << 1) + ord(c)
-      return h
-
-   # @property
-   # def hashed(self):
-   #    h = 5381
-   #    for c in self.name:
-   #       h = ((h << 5) + h) + ord(c)
-   #    return h
-
-   @property
-   def ftype(self):
-      return {
-         1: 'ufunc',
-         2: 'bfunc',
-         3: 'tfunc',
-      }[self.nargs]
+   def caller(self):
+      """object evaluator (t_psl_call) for [psl <name>]"""
+      if self.has_kernel:
+         return 'psl_call_scalar'
+      return f'psl_call_{self.name}'
 
    @property
    def slots(self):
+      # pd passes at most 5 typed arguments, so wider methods take A_GIMME
+      if self.nargs > 3:
+         return 'A_GIMME'
       _slots = ['A_DEFFLOAT'] * self.nargs
       return ", ".join(_slots)
 
+   @property
+   def has_kernel(self):
+      return self.name not in SIGNAL_SKIP_FUNCS
+
+   @property
+   def has_e(self):
+      """whether there is a gsl_sf_<name>_e form reporting an error estimate"""
+      return self.fullname.startswith('sf_')
+
+   @property
+   def has_mode(self):
+      return self.name in PREC_MODES
+
+   @property
+   def default_mode(self):
+      return PREC_MODES.get(self.name, 'GSL_PREC_DOUBLE')
+
+   def call(self, *args, mode=None):
+      """C expression applying the function to `args`"""
+      if self.name in CALL_EXPRS:
+         return CALL_EXPRS[self.name].format(*args)
+      if self.name in PREC_MODES:
+         args += (mode or self.default_mode,)
+      return f"gsl_{self.fullname}({', '.join(args)})"
+
+   def e_call(self, args, mode, result):
+      """C expression for the _e form, storing into the gsl_sf_result* `result`"""
+      if self.name in PREC_MODES:
+         args = list(args) + [mode]
+      return f"gsl_{self.fullname}_e({', '.join(list(args) + [result])})"
+
    @property
    def fullname(self):
       if self.func_name:
@@ -114,15 +371,60 @@ class Func:
          return self.name
 
 
+class ArrayFunc(Func):
+   """a gsl_sf_*_array family, see `array_items`"""
+   def __init__(self, name, func_name, ints, doubles, size):
+      super().__init__(len(ints) + len(doubles), name, func_name)
+      self.ints = ints
+      self.doubles = doubles
+      self.size = size
+
+   @property
+   def has_kernel(self):
+      return False
+
+   @property
+   def has_e(self):
+      return False
+
+   @property
+   def slots(self):
+      return 'A_GIMME'
+
+   @property
+   def params(self):
+      """C declarations binding the argument names to `a[i]`"""
+      return [f'int {n} = (int)a[{i}];' for i, n in enumerate(self.ints)] + \
+             [f'double {n} = a[{len(self.ints) + i}];' for i, n in enumerate(self.doubles)]
+
+   @property
+   def fill(self):
+      return f"gsl_{self.fullname}({', '.join(self.ints + self.doubles)}, res)"
+
+
 def render(**kwds):
     tmpl = Template(filename='templates/psl.c.mako')
     rendered = tmpl.render(**kwds)
     return rendered
 
 def main():
+   global VERBOSE
+   if '--verbose' in sys.argv:
+      VERBOSE = int(sys.argv[sys.argv.index('--verbose') + 1])
    funcs = [Func(i[0],i[1], i[2]) for i in items]
+   expr_funcs = [f for f in funcs if f.has_kernel]
+   expr_funcs += [Func(i[0],i[1], i[2]) for i in expr_items]
+   names = [f.name for f in expr_funcs]
+   if len(set(names)) != len(names):
+      raise SystemExit("render failed: duplicate expression function names")
+   array_funcs = [ArrayFunc(*i) for i in array_items]
+   if any(f.nargs > MAX_ARGS for f in funcs + array_funcs):
+      raise SystemExit(f"render failed: functions take at most {MAX_ARGS} arguments")
    with open('psl.c', 'w') as f:
-      f.write(render(funcs=funcs, skip=SKIP_FUNCS))
+      f.write(render(funcs=funcs, skip=SKIP_FUNCS, phash=PerfectHash(funcs + array_funcs),
+                     array_funcs=array_funcs,
+                     expr_funcs=expr_funcs, verbose=VERBOSE,
+                     max_args=MAX_ARGS))
 
 
 if __name__ == '__main__':
@@ -6,48 +6,119 @@ Features:
 - request calculation via message
 - function lookup
 - inlets-on-demand
+- signal-rate versions via [psl~ <func>]
 
 Author: shakfu
 Repo: https://github.com/shakfu/pd-psl.git
 
 */
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <string.h>
+
+#include <gsl/gsl_chebyshev.h>
+#include <gsl/gsl_dht.h>
+#include <gsl/gsl_errno.h>
+#include <gsl/gsl_fft_halfcomplex.h>
+#include <gsl/gsl_fft_real.h>
 #include <gsl/gsl_math.h>
+#include <gsl/gsl_movstat.h>
 #include <gsl/gsl_rng.h>
+#include <gsl/gsl_rstat.h>
 #include <gsl/gsl_sf_airy.h>
 #include <gsl/gsl_sf_bessel.h>
 #include <gsl/gsl_sf_clausen.h>
+#include <gsl/gsl_sf_coupling.h>
 #include <gsl/gsl_sf_dawson.h>
 #include <gsl/gsl_sf_debye.h>
-#include <math.h>
+#include <gsl/gsl_sf_dilog.h>
+#include <gsl/gsl_sf_ellint.h>
+#include <gsl/gsl_sf_erf.h>
+#include <gsl/gsl_sf_exp.h>
+#include <gsl/gsl_sf_expint.h>
+#include <gsl/gsl_sf_fermi_dirac.h>
+#include <gsl/gsl_sf_gamma.h>
+#include <gsl/gsl_sf_gegenbauer.h>
+#include <gsl/gsl_sf_hermite.h>
+#include <gsl/gsl_sf_hyperg.h>
+#include <gsl/gsl_sf_laguerre.h>
+#include <gsl/gsl_sf_lambert.h>
+#include <gsl/gsl_sf_legendre.h>
+#include <gsl/gsl_sf_log.h>
+#include <gsl/gsl_sf_psi.h>
+#include <gsl/gsl_sf_synchrotron.h>
+#include <gsl/gsl_sf_transport.h>
+#include <gsl/gsl_sf_trig.h>
+#include <gsl/gsl_sf_zeta.h>
+#include <gsl/gsl_sort.h>
+#include <gsl/gsl_statistics_double.h>
+#include <gsl/gsl_vector.h>
+#include <gsl/gsl_wavelet.h>
+#include <gsl/gsl_wavelet2d.h>
 
 #include "m_pd.h"
+#include "tinyexpr.h"
 
 
 // macros and defines
 //  ---------------------------------------------------------------------------
 
 
-#define MAX_ARGS 6
+#define MAX_ARGS ${max_args}
 #define STR_BUF_SIZE 1000
+#define APPLY_CHUNK 256
+#define LIST_PREALLOC 512
+#define ARRAY_MAX_SIZE 65536
+#define PSL_WORKERS 2
+#define PSL_QUEUE_SIZE 64        // jobs per worker, a power of two
+#define PSL_POLL_MS 1
+
+// diagnostics: PSL_VERBOSE is the highest level compiled in (1: setup,
+// 2: every message); 0 removes the posts and their formatting entirely.
+// The `verbose` message picks the level at runtime.
+#ifndef PSL_VERBOSE
+#define PSL_VERBOSE ${verbose}
+#endif
+
+#if PSL_VERBOSE
+#define psl_debug(x, level, ...) ${'\\'}
+    do { if ((x)->verbose >= (level)) post(__VA_ARGS__); } while (0)
+#define psl_debug_args(x, level, argc, argv) ${'\\'}
+    do { if ((x)->verbose >= (level)) psl_post_args(argc, argv); } while (0)
+#else
+#define psl_debug(x, level, ...) ((void)0)
+#define psl_debug_args(x, level, argc, argv) ((void)0)
+#endif
+#define EXPR_CACHE_SIZE 64
+#define EXPR_CACHE_BUCKETS 128
 
 
 // function lookup infratructure
 // ---------------------------------------------------------------------------
 
-unsigned long hash(const char *str) {
-    unsigned int h = 0;
-    int c;
+// FNV-1a with a seed: must match `hash()` in scripts/render.py
+static uint32_t psl_hash(const char *str, uint32_t seed) {
+    uint32_t h = 2166136261u ^ seed;
+    unsigned char c;
 
-    while ((c = *str++)) 
-        h += (h << 1) + c;
+    while ((c = (unsigned char)*str++)) {
+        h ^= c;
+        h *= 16777619u;
+    }
 
     return h;
 }
 
 
-enum FUNC {
-    % for f in funcs:
-    ${f.name.upper()} = ${f.hashed},
+// minimal perfect hash generated by scripts/render.py: the bucket
+// hash(name, 0) % N holds the seed which maps name to its slot in psl_funcs
+#define N_FUNCS ${phash.size}
+
+static const uint32_t psl_func_disp[N_FUNCS] = {
+    % for i in range(0, phash.size, 8):
+    ${", ".join(str(d) for d in phash.disp[i:i+8])},
     % endfor
 };
 
@@ -57,8 +128,22 @@ enum FUNC {
 
 
 typedef struct _psl t_psl;
+typedef struct _psl_func t_psl_func;
 
 void select_default_function(t_psl *x, t_symbol *s);
+void psl_map(t_psl *x, t_symbol *s, int argc, t_atom *argv);
+static t_word *psl_getarray(void *x, t_symbol *s, int *n, t_garray **ga);
+static void psl_movstat_bang(t_psl *x);
+
+#if PSL_VERBOSE
+static void psl_post_args(int argc, t_atom *argv) {
+    char buf[STR_BUF_SIZE];
+    for (int i = 0; i < argc; i++) {
+        atom_string((argv+i), buf, STR_BUF_SIZE);
+        post("arg+%i: %s", i, buf);
+    }
+}
+#endif
 
 
 // psl class objects
@@ -69,14 +154,121 @@ static t_class *psl_class;
 
 static t_class *psl_inlet_class;
 
+static t_class *psl_tilde_class;
+
+static t_class *psl_fft_class;
+
+static t_class *psl_wavelet_class;
+
+static t_class *psl_rstat_class;
+
+static t_class *psl_stft_class;
+
+static t_class *psl_istft_class;
+
+
+// gsl error handling
+// ---------------------------------------------------------------------------
+
+
+// GSL's default handler aborts, which would take pd down with it. psl_setup
+// installs psl_gsl_error instead, which only counts: errors go to the object
+// evaluating at the time (see PSL_COUNTING) and are reported by [errors(.
+// The offending call returns NaN (or its status, for the _e forms).
+
+typedef struct _psl_errors {
+    atomic_uint count;              // errors since the last report
+    atomic_int status;              // gsl_errno of the latest
+    _Atomic(const char *) reason;   // and its message
+} t_psl_errors;
+
+
+// per thread, so that signal and worker threads count for their own objects
+static _Thread_local t_psl_errors *psl_errors_current;
+
+
+static void psl_gsl_error(const char *reason, const char *file, int line,
+                          int gsl_errno) {
+    t_psl_errors *e = psl_errors_current;
+    (void)file;
+    (void)line;
+
+    // outside of any evaluation, e.g. while fitting a table at creation
+    if (!e) {
+        return;
+    }
+    atomic_fetch_add_explicit(&e->count, 1, memory_order_relaxed);
+    atomic_store_explicit(&e->status, gsl_errno, memory_order_relaxed);
+    atomic_store_explicit(&e->reason, reason, memory_order_relaxed);
+}
+
+
+// run `stmt` with gsl errors counted against the object x
+#define PSL_COUNTING(x, stmt) ${'\\'}
+    do { ${'\\'}
+        t_psl_errors *prev_ = psl_errors_current; ${'\\'}
+        psl_errors_current = &(x)->errors; ${'\\'}
+        stmt; ${'\\'}
+        psl_errors_current = prev_; ${'\\'}
+    } while (0)
+
+
+static void psl_errors_init(t_psl_errors *e) {
+    atomic_init(&e->count, 0);
+    atomic_init(&e->status, 0);
+    atomic_init(&e->reason, NULL);
+}
+
+
+// post and reset the count
+static void psl_errors_report(const char *cls, const char *name, t_psl_errors *e) {
+    unsigned int n = atomic_exchange_explicit(&e->count, 0, memory_order_relaxed);
+    if (!n) {
+        post("%s %s: no gsl errors", cls, name);
+        return;
+    }
+    int status = atomic_load_explicit(&e->status, memory_order_relaxed);
+    const char *reason = atomic_load_explicit(&e->reason, memory_order_relaxed);
+    post("%s %s: %u gsl error%s, last: %s (%s)", cls, name, n, n == 1 ? "" : "s",
+        gsl_strerror(status), reason ? reason : "");
+}
+
 
 // psl class struct (data-space)
 // ---------------------------------------------------------------------------
 
 
-typedef void (*unary_func)(t_psl *, t_floatarg);
-typedef void (*binary_func)(t_psl *, t_floatarg, t_floatarg);
-typedef void (*tri_func)(t_psl *, t_floatarg, t_floatarg, t_floatarg);
+// object evaluator: applies the selected function to the argument array and
+// sends out the result, whatever the arity
+typedef void (*t_psl_call)(t_psl *x, const double *args);
+
+// signal kernel: evaluates a function over a block of `n` samples
+typedef void (*t_psl_kernel)(int n, t_sample **in, t_sample *out);
+
+// scalar evaluator: the function applied to an argument array
+typedef double (*t_psl_scalar)(const double *args);
+
+// error-estimate evaluator: the gsl_sf_*_e form, returns the gsl status
+typedef int (*t_psl_efunc)(const double *args, gsl_mode_t mode, gsl_sf_result *r);
+
+// precision for functions taking a gsl_mode_t: the object's choice, or the
+// function's own default while it has none
+#define PSL_MODE(x, dflt) ((x)->mode < 0 ? (dflt) : (gsl_mode_t)(x)->mode)
+
+
+// [psl movstat ...]: one gsl_movstat accumulator, fed a value at a time by
+// incoming floats, and the workspace to run it over whole arrays
+typedef struct _psl_movstat {
+    const gsl_movstat_accum *accum;
+    void *params;                 // &param, &func or NULL, as accum wants
+    double param;                 // q for qqr and quantile, scale for mad
+    gsl_movstat_function func;    // quantile, through the userfunc accumulator
+    int window;
+    int two;                      // the result is the second value (mad)
+    int count;                    // values since creation or [reset(
+    void *state;                  // accum->size(window) bytes
+    gsl_movstat_workspace *work;  // centred window, allocated on first use
+} t_psl_movstat;
 
 
 typedef struct _psl_inlet
@@ -94,15 +286,40 @@ typedef struct _psl {
     t_symbol *func_name;
     int nargs;
 
-    // function slots
-    unary_func ufunc;
-    binary_func bfunc;
-    tri_func tfunc;
+    int verbose;         // diagnostics level, see PSL_VERBOSE
+
+    // function slot: call(x, arg_array) evaluates func with nargs arguments
+    t_psl_func *func;    // NULL for expressions
+    t_psl_call call;     // NULL when no function is selected
+    int mode;            // gsl_mode_t from [precision(, -1 for the default
+    t_psl_errors errors; // gsl errors while evaluating
+    int async;           // run apply and the _array families on the pool
 
     // param_array
-    t_float *arg_array;
+    double *arg_array;   // MAX_ARGS values, also bound to expr variables
+
+    // for expression
+    char expr_buffer[MAXPDSTRING];
+    te_program *expr;    // compiled [psl expr ...] expression
+
+    // chebyshev approximation (unary functions only)
+    gsl_cheb_series *cheb;
+
+    // [psl dht ...]: the plan and the input and output of gsl_dht_apply
+    gsl_dht *dht;
+    double *dht_buf;     // 2 * dht->size
+
+    t_psl_movstat *movstat;
+
+    // random number generation
+    const gsl_rng_type *rng_type;
+    gsl_rng *rng;        // allocated on first use
 
-    // private vars
+    // list output (map, rando): kept between calls, grown on demand
+    t_atom *list_av;
+    int list_size;
+    double *vec_buf;     // results of the _array families
+    int vec_size;
 
     // inlets
     int inlets;          // # of extra inlets in addition to default
@@ -110,281 +327,3617 @@ typedef struct _psl {
 
     // outlets
     t_outlet *out_f;
+    t_outlet *out_err;   // error estimate, only with -err
 } t_psl;
 
 
-// psl class methods (operation-space)
+// worker pool
 // ---------------------------------------------------------------------------
 
 
-// typed-methods
+// With -async (or [async 1(), `apply` and the _array families run on a few
+// worker threads so that long computations do not hold up the scheduler.
+// Jobs are filled in and taken out on the scheduler: a worker only touches
+// its job, never the object or a garray. Every worker has two single-producer
+// single-consumer rings, jobs in and finished jobs out; the out rings are
+// emptied by a clock that polls while jobs are outstanding. All jobs of one
+// object go to the same worker, so its results arrive in order.
+
+typedef struct _psl_job t_psl_job;
+
+struct _psl_job {
+    void (*work)(t_psl_job *job);           // on a worker
+    void (*done)(t_psl *x, t_psl_job *job); // on the scheduler
+    t_psl *owner;                           // NULL once the object is freed
+    t_psl_job *next;                        // outstanding jobs
+    t_psl_job *wait;                        // worker backlog, in order
+    const void *func;                       // t_psl_func or t_psl_array_func
+    double args[MAX_ARGS];
+    t_symbol *dst;                          // destination array, if any
+    double *data;                           // n values, in and/or out
+    int n;
+    int status;
+    int mode;                               // apply: gsl_mode_t of the _e form,
+                                            // -1 for the kernel
+    double err;                             // apply: largest error estimate
+    t_psl_errors errors;                    // counted on the worker
+};
 
-void psl_bang(t_psl *x) {
-    if (x->nargs == 1 && x->inlets == 0) {
-        x->ufunc(x, x->arg_array[0]);
+
+typedef struct _psl_queue {
+    t_psl_job *slots[PSL_QUEUE_SIZE];
+    atomic_uint head;   // next to pop, advanced by the consumer
+    atomic_uint tail;   // next to push, advanced by the producer
+} t_psl_queue;
+
+
+static int psl_queue_push(t_psl_queue *q, t_psl_job *job) {
+    unsigned int tail = atomic_load_explicit(&q->tail, memory_order_relaxed);
+    if (tail - atomic_load_explicit(&q->head, memory_order_acquire) == PSL_QUEUE_SIZE) {
+        return 0;
     }
+    q->slots[tail % PSL_QUEUE_SIZE] = job;
+    atomic_store_explicit(&q->tail, tail + 1, memory_order_release);
+    return 1;
+}
 
-    if (x->nargs == 2 && x->inlets == 1) {
-        x->bfunc(x, x->arg_array[0], x->arg_array[1]);
+
+static t_psl_job *psl_queue_pop(t_psl_queue *q) {
+    unsigned int head = atomic_load_explicit(&q->head, memory_order_relaxed);
+    if (head == atomic_load_explicit(&q->tail, memory_order_acquire)) {
+        return NULL;
     }
+    t_psl_job *job = q->slots[head % PSL_QUEUE_SIZE];
+    atomic_store_explicit(&q->head, head + 1, memory_order_release);
+    return job;
+}
+
+
+typedef struct _psl_worker {
+    pthread_t thread;
+    pthread_mutex_t lock;   // only for sleeping while idle
+    pthread_cond_t wake;
+    t_psl_queue in;         // scheduler -> worker
+    t_psl_queue out;        // worker -> scheduler
+    int pending;            // submitted and not collected, scheduler side
+    t_psl_job *backlog;     // waiting for a slot in `in`, scheduler side
+    t_psl_job **backlog_end;
+} t_psl_worker;
+
+
+// started on first use and kept until pd exits
+static struct {
+    t_psl_worker workers[PSL_WORKERS];
+    int started;        // 1 once started, -1 if no thread could be started
+    int n;              // workers running, at most PSL_WORKERS
+    t_clock *clock;
+    t_psl_job *outstanding;
+} psl_pool;
+
+
+static void *psl_worker_main(void *arg) {
+    t_psl_worker *w = (t_psl_worker *)arg;
+    t_psl_job *job;
+
+    for (;;) {
+        pthread_mutex_lock(&w->lock);
+        while (!(job = psl_queue_pop(&w->in))) {
+            pthread_cond_wait(&w->wake, &w->lock);
+        }
+        pthread_mutex_unlock(&w->lock);
+
+        psl_errors_current = &job->errors;
+        job->work(job);
+        psl_errors_current = NULL;
 
-    if (x->nargs == 3 && x->inlets == 2) {
-        x->tfunc(x, x->arg_array[0], x->arg_array[1], x->arg_array[2]);
+        // never full: a worker has at most PSL_QUEUE_SIZE jobs pending
+        psl_queue_push(&w->out, job);
     }
+    return NULL;
+}
+
 
+static void psl_job_free(t_psl_job *job) {
+    freebytes(job->data, job->n * sizeof(double));
+    freebytes(job, sizeof(*job));
 }
 
-void psl_float(t_psl *x, t_floatarg f) {
-    post("psl_float: %f", f);
-    if (x->nargs > 0) {
-        x->arg_array[0] = f;
-        psl_bang(x);
-    } else {
-        post("nothing to do: no function selected.");
-        outlet_float(x->out_f, f);
+
+static void psl_job_finish(t_psl_job *job) {
+    t_psl_job **p = &psl_pool.outstanding;
+    while (*p != job) {
+        p = &(*p)->next;
+    }
+    *p = job->next;
+
+    t_psl *x = job->owner;
+    if (x) {
+        unsigned int n = atomic_load_explicit(&job->errors.count, memory_order_relaxed);
+        if (n) {
+            atomic_fetch_add_explicit(&x->errors.count, n, memory_order_relaxed);
+            atomic_store_explicit(&x->errors.status,
+                atomic_load_explicit(&job->errors.status, memory_order_relaxed),
+                memory_order_relaxed);
+            atomic_store_explicit(&x->errors.reason,
+                atomic_load_explicit(&job->errors.reason, memory_order_relaxed),
+                memory_order_relaxed);
+        }
+        job->done(x, job);
     }
+    psl_job_free(job);
 }
 
-void psl_list(t_psl *x, t_symbol *s, int argc, t_atom *argv) {
 
-    if (s == gensym("list")) {
-        post("s: list");
+static void psl_worker_push(t_psl_worker *w, t_psl_job *job) {
+    w->pending++;
+    pthread_mutex_lock(&w->lock);
+    psl_queue_push(&w->in, job);
+    pthread_cond_signal(&w->wake);
+    pthread_mutex_unlock(&w->lock);
+}
 
-        if (argc == 0) {
-            return;
-        }
 
-        if (argc == 1) {
-            if (argv->a_type == A_FLOAT) {
-                float f = atom_getfloat(argv);
-                post("got float: %f", f);
-                x->ufunc(x, f);
-                return;
-            }
+static void psl_pool_poll(void *dummy) {
+    (void)dummy;
+    for (int i = 0; i < psl_pool.n; i++) {
+        t_psl_worker *w = &psl_pool.workers[i];
+        t_psl_job *job;
+        while ((job = psl_queue_pop(&w->out))) {
+            w->pending--;
+            psl_job_finish(job);
         }
-
-        if (argc == 2) {
-            char buf[STR_BUF_SIZE];
-            for (int i = 0; i < argc; i++) {
-                atom_string((argv+i), buf, STR_BUF_SIZE);
-                post("arg+%i: %s", i, buf);
-            }
-            if (argv->a_type == A_FLOAT && (argv + 1)->a_type == A_FLOAT) {
-                float f1 = atom_getfloat(argv+0);
-                float f2 = atom_getfloat(argv+1);
-                post("f(%.2f, %.2f)", f1, f2);
-                x->bfunc(x, f1, f2);
-                return;
+        // the backlog follows the jobs already queued, so order is kept
+        while (w->backlog && w->pending < PSL_QUEUE_SIZE) {
+            job = w->backlog;
+            if (!(w->backlog = job->wait)) {
+                w->backlog_end = &w->backlog;
             }
+            psl_worker_push(w, job);
         }
+    }
+    if (psl_pool.outstanding) {
+        clock_delay(psl_pool.clock, PSL_POLL_MS);
+    }
+}
 
-        if (argc == 3) {
-            char buf[STR_BUF_SIZE];
-            for (int i = 0; i < argc; i++) {
-                atom_string((argv+i), buf, STR_BUF_SIZE);
-                post("arg+%i: %s", i, buf);
-            }
-            if (argv->a_type == A_FLOAT && (argv+1)->a_type == A_FLOAT && (argv+2)->a_type == A_FLOAT) {
-                float f1 = atom_getfloat(argv+0);
-                float f2 = atom_getfloat(argv+1);
-                float f3 = atom_getfloat(argv+2);                
-                post("f(%.2f, %.2f, %.2f)", f1, f2, f3);
-                x->tfunc(x, f1, f2, f3);
-                return;
-            }
+
+// tried once: the pool runs with the threads that started, or not at all
+static int psl_pool_start(void) {
+    for (int i = 0; i < PSL_WORKERS; i++) {
+        t_psl_worker *w = &psl_pool.workers[i];
+        atomic_init(&w->in.head, 0);
+        atomic_init(&w->in.tail, 0);
+        atomic_init(&w->out.head, 0);
+        atomic_init(&w->out.tail, 0);
+        w->pending = 0;
+        w->backlog = NULL;
+        w->backlog_end = &w->backlog;
+        pthread_mutex_init(&w->lock, NULL);
+        pthread_cond_init(&w->wake, NULL);
+        if (pthread_create(&w->thread, NULL, psl_worker_main, w)) {
+            pthread_mutex_destroy(&w->lock);
+            pthread_cond_destroy(&w->wake);
+            pd_error(0, "psl: could only start %d of %d worker threads", i, PSL_WORKERS);
+            break;
         }
+        pthread_detach(w->thread);
+        psl_pool.n++;
+    }
+    if (!psl_pool.n) {
+        psl_pool.started = -1;
+        return 0;
+    }
+    psl_pool.clock = clock_new(&psl_pool, (t_method)psl_pool_poll);
+    psl_pool.started = 1;
+    return 1;
+}
+
+
+// hand job to x's worker, or to its backlog while the worker is busy, so
+// that the jobs of one object stay in order; 0 if the pool is unavailable
+static int psl_pool_submit(t_psl *x, t_psl_job *job) {
+    if (psl_pool.started < 0 || (!psl_pool.started && !psl_pool_start())) {
+        return 0;
     }
 
-    post("list body");
-    return;
+    t_psl_worker *w = &psl_pool.workers[((uintptr_t)x >> 4) % psl_pool.n];
+
+    job->owner = x;
+    psl_errors_init(&job->errors);
+    job->next = psl_pool.outstanding;
+    psl_pool.outstanding = job;
 
-    // error:
-    //     pd_error(x, "psl_list error: incorrect arg type");
+    if (w->pending == PSL_QUEUE_SIZE || w->backlog) {
+        psl_debug(x, 1, "psl: pool busy, job waits for a slot");
+        job->wait = NULL;
+        *w->backlog_end = job;
+        w->backlog_end = &job->wait;
+    } else {
+        psl_worker_push(w, job);
+    }
+
+    clock_delay(psl_pool.clock, PSL_POLL_MS);
+    return 1;
 }
 
-// message-methods
 
-void psl_add(t_psl *x, t_floatarg f1, t_floatarg f2) {
-    outlet_float(x->out_f, f1+f2);
+// on the pool when there is one, otherwise right away
+static void psl_job_run(t_psl *x, t_psl_job *job) {
+    if (psl_pool_submit(x, job)) {
+        return;
+    }
+    psl_debug(x, 1, "psl: no worker threads, running in the scheduler");
+    PSL_COUNTING(x, job->work(job));
+    job->done(x, job);
+    psl_job_free(job);
 }
 
-void psl_rando(t_psl *x, t_floatarg n, t_floatarg seed) {
-    post("rando: n:%.2f seed:%.2f", n, seed);
-    gsl_rng_env_setup();
 
-    int argc = (int)n;
-    int _seed = (int)seed;
+static t_psl_job *psl_job_new(const void *func, int n) {
+    t_psl_job *job = (t_psl_job *)getbytes(sizeof(*job));
+    job->func = func;
+    job->n = n;
+    job->data = (double *)getbytes(n * sizeof(double));
+    job->mode = -1;
+    return job;
+}
 
-    gsl_rng *r = gsl_rng_alloc(gsl_rng_mt19937);
-    gsl_rng_set(r, _seed);
 
-    t_atom av[argc];
-    for (int i = 0; i < argc; i++) {
-        SETFLOAT(av + i, gsl_rng_uniform(r));
+// results of a freed object are dropped when they arrive
+static void psl_pool_forget(t_psl *x) {
+    for (t_psl_job *job = psl_pool.outstanding; job; job = job->next) {
+        if (job->owner == x) {
+            job->owner = NULL;
+        }
     }
-    outlet_list(x->out_f, gensym("list"), argc, av);
-
-    gsl_rng_free(r);
 }
 
-void psl_airy_ai(t_psl *x, t_floatarg f) {
-    outlet_float(x->out_f, gsl_sf_airy_Ai(f, GSL_PREC_APPROX));
+
+// psl class methods (operation-space)
+// ---------------------------------------------------------------------------
+
+
+// typed-methods
+
+// evaluate with the current arguments
+static void psl_eval(t_psl *x) {
+    if (x->call) {
+        PSL_COUNTING(x, x->call(x, x->arg_array));
+    }
 }
 
-void psl_airy_bi(t_psl *x, t_floatarg f) {
-    outlet_float(x->out_f, gsl_sf_airy_Bi(f, GSL_PREC_APPROX));
+// [psl movstat] keeps state, so a bang only repeats the current value
+void psl_bang(t_psl *x) {
+    if (x->movstat) {
+        psl_movstat_bang(x);
+        return;
+    }
+    psl_eval(x);
 }
 
-% for f in funcs:
-% if f.name not in skip:
-% if f.nargs == 1:
-void psl_${f.name}(t_psl *x, t_floatarg f) {
-    outlet_float(x->out_f, gsl_${f.fullname}(f));
+void psl_float(t_psl *x, t_floatarg f) {
+    psl_debug(x, 2, "psl_float: %f", f);
+    if (x->nargs > 0) {
+        x->arg_array[0] = f;
+        psl_eval(x);
+    } else {
+        psl_debug(x, 1, "nothing to do: no function selected.");
+        outlet_float(x->out_f, f);
+    }
 }
 
-% endif
-% if f.nargs == 2:
-void psl_${f.name}(t_psl *x, t_floatarg f1, t_floatarg f2) {
-    outlet_float(x->out_f, gsl_${f.fullname}(f1, f2));
+void psl_list(t_psl *x, t_symbol *s, int argc, t_atom *argv) {
+
+    // atom_post("psl_list: ", argc, argv);
+
+    // a unary function maps over longer lists
+    if (x->nargs == 1 && argc > 1) {
+        psl_map(x, s, argc, argv);
+        return;
+    }
+
+    // the list fills the arguments in order, the rest keep their values
+    if (x->nargs > 0 && argc > 0) {
+        psl_debug(x, 2, "s: %s", s->s_name);
+        psl_debug_args(x, 2, argc, argv);
+        for (int i = 0; i < argc && i < x->nargs; i++) {
+            x->arg_array[i] = atom_getfloat(argv + i);
+        }
+        psl_eval(x);
+        return;
+    }
+
+    psl_debug(x, 2, "list body");
 }
 
-% endif
-% if f.nargs == 3:
-void psl_${f.name}(t_psl *x, t_floatarg f1, t_floatarg f2, t_floatarg f3) {
-    outlet_float(x->out_f, gsl_${f.fullname}(f1, f2, f3));
+
+
+// compiled expression cache: symbol messages are interned, so the same
+// expression always arrives as the same t_symbol* and can be looked up by
+// pointer. The least recently used entry is evicted when the cache is full.
+// Entries hold the flattened program rather than the tinyexpr tree.
+
+typedef struct _psl_expr_entry {
+    t_symbol *key;
+    te_program *expr;
+    struct _psl_expr_entry *prev;   // recency list, most recent first
+    struct _psl_expr_entry *next;
+    struct _psl_expr_entry *chain;  // next entry in the same bucket
+} t_psl_expr_entry;
+
+
+static struct {
+    t_psl_expr_entry entries[EXPR_CACHE_SIZE];
+    t_psl_expr_entry *buckets[EXPR_CACHE_BUCKETS];
+    t_psl_expr_entry *head;
+    t_psl_expr_entry *tail;
+    int count;
+} psl_expr_cache;
+
+
+// expression functions: double-only wrappers, since tinyexpr calls every
+// function through double (*)(double, ...), marked pure so that calls with
+// constant arguments are folded by te_compile
+% for f in expr_funcs:
+static double psl_te_${f.name}(${", ".join('double a%d' % i for i in range(f.nargs))}) {
+    return ${f.call(*['a%d' % i for i in range(f.nargs)])};
 }
 
-% endif
-% endif
 % endfor
 
+static te_variable psl_te_vars[] = {
+    % for f in expr_funcs:
+    {"${f.name}", psl_te_${f.name}, TE_FUNCTION${f.nargs} | TE_FLAG_PURE, NULL},
+    % endfor
+};
 
-// function selection
-//---------------------------------------------------------------------------
+#define N_TE_VARS (int)(sizeof(psl_te_vars) / sizeof(psl_te_vars[0]))
 
 
-// set default function from symbol
-void select_default_function(t_psl *x, t_symbol *s) {
-    x->func_name = s;
-    post("func %s selected", s->s_name);
+static inline unsigned int psl_expr_bucket(t_symbol *s) {
+    return ((uintptr_t)s >> 4) % EXPR_CACHE_BUCKETS;
+}
 
-    switch (hash(s->s_name)) {
-        % for f in funcs:
-        case ${f.name.upper()}:
-            x->nargs = ${f.nargs};
-            x->${f.ftype} = &psl_${f.name};
-            break;
-        % endfor
-        default:
-            post("func selection failed, reverting to defaults");
-            break;
-   }
+
+static void psl_expr_unlink(t_psl_expr_entry *e) {
+    if (e->prev) e->prev->next = e->next; else psl_expr_cache.head = e->next;
+    if (e->next) e->next->prev = e->prev; else psl_expr_cache.tail = e->prev;
 }
 
 
-// psl-inlet funcs
-// ---------------------------------------------------------------------------
+static void psl_expr_push(t_psl_expr_entry *e) {
+    e->prev = NULL;
+    e->next = psl_expr_cache.head;
+    if (e->next) e->next->prev = e; else psl_expr_cache.tail = e;
+    psl_expr_cache.head = e;
+}
 
 
-static void psl_inlet_float(t_psl_inlet *x, float f)
-{
-    x->owner->arg_array[x->id+1] = f;
-    // outlet_float(x->owner->out_f, x->id + f);
-    post("x->owner->arg_array[x->id]: %.02f", x->owner->arg_array[x->id+1]);
-    psl_bang(x->owner);
+static te_program *psl_expr_lookup(t_symbol *s) {
+    t_psl_expr_entry *e = psl_expr_cache.buckets[psl_expr_bucket(s)];
+
+    for (; e; e = e->chain) {
+        if (e->key == s) {
+            if (e != psl_expr_cache.head) {
+                psl_expr_unlink(e);
+                psl_expr_push(e);
+            }
+            return e->expr;
+        }
+    }
+    return NULL;
 }
 
 
-// psl class constructor
-// ---------------------------------------------------------------------------
+static void psl_expr_insert(t_symbol *s, te_program *expr) {
+    t_psl_expr_entry *e;
 
+    if (psl_expr_cache.count < EXPR_CACHE_SIZE) {
+        e = &psl_expr_cache.entries[psl_expr_cache.count++];
+    } else {
+        // evict the least recently used
+        e = psl_expr_cache.tail;
+        psl_expr_unlink(e);
+        t_psl_expr_entry **p = &psl_expr_cache.buckets[psl_expr_bucket(e->key)];
+        while (*p != e) {
+            p = &(*p)->chain;
+        }
+        *p = e->chain;
+        te_free_program(e->expr);
+    }
 
-void *psl_new(t_symbol *s) {
-    t_psl *x = (t_psl *)pd_new(psl_class);
+    unsigned int b = psl_expr_bucket(s);
+    e->key = s;
+    e->expr = expr;
+    e->chain = psl_expr_cache.buckets[b];
+    psl_expr_cache.buckets[b] = e;
+    psl_expr_push(e);
+}
 
-    // initialize variables
-    x->nargs = 0;
-    x->inlets = 0;
-    x->ufunc = NULL;
-    x->bfunc = NULL;
-    x->tfunc = NULL;
 
-    select_default_function(x, s);
-    // sets x->nargs to correct number
+// strip the escapes pd requires for commas into buf (MAXPDSTRING) and compile
+static te_expr *psl_expr_compile(void *x, char *buf, const char *str,
+                                 const te_variable *vars, int var_count) {
+    int length = strlen(str);
+    int err = 0;
 
-    // create inlets
-    x->inlets = x->nargs - 1;
-    x->ins = (t_psl_inlet *)getbytes(x->inlets * sizeof(*x->ins));
-    x->arg_array = malloc(x->inlets * sizeof(float));
-    
-    for (int i=0; i < x->inlets; i++) {
-        x->ins[i].x_pd = psl_inlet_class;
-        x->ins[i].owner = x;
-        x->ins[i].id = i;
-        x->arg_array[i] = 0.0;
-        inlet_new((t_object *)x, &(x->ins[i].x_pd), 0, 0);
+    if (length >= MAXPDSTRING) {
+        pd_error(x, "psl: expression too long");
+        return NULL;
     }
 
+    int j = 0;
+    for (int i = 0; i < length; i++) {
+        // remove escape `\` required for commas
+        if (str[i] != '\\') {
+            buf[j++] = str[i];
+        } else if (j > 0 && buf[j - 1] == ' ') {
+            j--;
+        }
+    }
+    buf[j] = '\0';
 
-    // initialize outlets
-    x->out_f = outlet_new(&x->x_obj, &s_float);
+    te_expr *expr = te_compile(buf, vars, var_count, &err);
+    if (!expr) {
+        pd_error(x, "psl: parse error at %d in '%s'", err, buf);
+    }
+    return expr;
+}
 
-    return (void *)x;
+
+// flatten the tree into a postfix program for evaluation, consuming the tree
+static te_program *psl_expr_lower(void *x, te_expr *expr) {
+    te_program *prog = te_compile_program(expr);
+    te_free(expr);
+    if (!prog) {
+        pd_error(x, "psl: out of memory compiling expression");
+    }
+    return prog;
 }
 
 
-// psl class destructor
-// ---------------------------------------------------------------------------
+void psl_symbol(t_psl *x, t_symbol *s) {
+    psl_debug(x, 2, "s: %s", s->s_name);
 
+    te_program *prog = psl_expr_lookup(s);
 
-// TODO: not sure if this is correct!
-void psl_free(t_psl *x) {
-    free(x->arg_array);
-    freebytes(x->ins, x->inlets * sizeof(*x->ins));
-    post("DONE");
+    if (!prog) {
+        te_expr *expr = psl_expr_compile(x, x->expr_buffer, s->s_name,
+                                         psl_te_vars, N_TE_VARS);
+        if (!expr || !(prog = psl_expr_lower(x, expr))) {
+            return;
+        }
+        psl_debug(x, 1, "expr_buffer: %s", x->expr_buffer);
+        psl_expr_insert(s, prog);
+    }
+
+    double res;
+    PSL_COUNTING(x, res = te_eval_program(prog));
+    outlet_float(x->out_f, res);
 }
 
 
-// psl class setup
+// [psl expr ...]: the expression is compiled once at creation with the
+// variables a, b, c, ... bound directly to arg_array, one per inlet.
+// [psl~ expr ...] binds them to per-inlet sample blocks instead.
 // ---------------------------------------------------------------------------
 
 
-void psl_setup(void) {
+// no `e`: a variable of that name would shadow tinyexpr's constant
+static const char *psl_expr_varnames[MAX_ARGS] = {"a", "b", "c", "d", "f", "g"};
 
-    psl_inlet_class = class_new(gensym("psl-inlet"), 
-                                0, 0, 
-                                sizeof(t_psl_inlet),
-                                CLASS_PD,
-                                0);
 
-    if (psl_inlet_class) {
-        class_addfloat(psl_inlet_class, (t_method)psl_inlet_float);
+// highest variable index (into base) the expression refers to, -1 if none
+static int psl_expr_maxarg(const double *base, const te_expr *n) {
+    int type = n->type & 0x1f;     // TYPE_MASK in tinyexpr.c
+    int max = -1;
+
+    if (type == TE_VARIABLE) {
+        int i = n->bound - base;
+        return (i >= 0 && i < MAX_ARGS) ? i : -1;
     }
+    if (type >= TE_FUNCTION0) {
+        int arity = n->type & 0x7;  // ARITY in tinyexpr.c
+        for (int i = 0; i < arity; i++) {
+            int m = psl_expr_maxarg(base, n->parameters[i]);
+            if (m > max) max = m;
+        }
+    }
+    return max;
+}
 
-    psl_class = class_new(gensym("psl"),
-                        (t_newmethod)psl_new,
-                        (t_method)psl_free,  // destructor
-                        sizeof(t_psl), 
-                        CLASS_DEFAULT, 
-                        A_DEFSYMBOL, 
-                        0);
 
-    // typed methods
-    class_addbang(psl_class, psl_bang);
-    class_addfloat(psl_class, psl_float);
-    class_addlist(psl_class, psl_list);
+// join the creation arguments and compile them with a..f bound to base[0..5]
+static te_expr *psl_expr_parse(void *x, const char *cls, char *buf,
+                               int argc, t_atom *argv, double *base) {
+    te_variable vars[N_TE_VARS + MAX_ARGS];
+    char text[MAXPDSTRING] = "", atom[MAXPDSTRING];
 
+    // the expression may have been split into several atoms by pd
+    for (int i = 0; i < argc; i++) {
+        atom_string(argv + i, atom, MAXPDSTRING);
+        if (strlen(text) + strlen(atom) + 2 > MAXPDSTRING) {
+            pd_error(x, "%s expr: expression too long", cls);
+            return NULL;
+        }
+        if (i) strcat(text, " ");
+        strcat(text, atom);
+    }
 
-    // message methods
+    // allow [psl expr "a + b"]
+    char *str = text;
+    int length = strlen(str);
+    if (length >= 2 && str[0] == '"' && str[length - 1] == '"') {
+        str[length - 1] = '\0';
+        str++;
+    }
 
-    // class-addmethods
-    % for f in funcs:
-    class_addmethod(psl_class, (t_method)psl_${f.name},  gensym("${f.name}"), ${f.slots}, 0);
-    % endfor
+    memcpy(vars, psl_te_vars, sizeof(psl_te_vars));
+    for (int i = 0; i < MAX_ARGS; i++) {
+        vars[N_TE_VARS + i].name = psl_expr_varnames[i];
+        vars[N_TE_VARS + i].address = &base[i];
+        vars[N_TE_VARS + i].type = TE_VARIABLE;
+        vars[N_TE_VARS + i].context = NULL;
+    }
 
-    // create alias
-    class_addcreator((t_newmethod)psl_new, gensym("gsl"), A_DEFSYMBOL, 0);
+    return psl_expr_compile(x, buf, str, vars, N_TE_VARS + MAX_ARGS);
+}
 
-    // set name of default help file
-    class_sethelpsymbol(psl_class, gensym("help-psl"));
+
+static void psl_call_expr(t_psl *x, const double *args) {
+    outlet_float(x->out_f, te_eval_program(x->expr));
+}
+
+
+static int psl_expr_init(t_psl *x, int argc, t_atom *argv) {
+    te_expr *expr = psl_expr_parse(x, "psl", x->expr_buffer, argc, argv, x->arg_array);
+    if (!expr) {
+        return 0;
+    }
+
+    int max = psl_expr_maxarg(x->arg_array, expr);
+    if (!(x->expr = psl_expr_lower(x, expr))) {
+        return 0;
+    }
+    x->nargs = max < 0 ? 1 : max + 1;
+    x->call = psl_call_expr;
+    x->func_name = gensym("expr");
+    return 1;
+}
+
+
+// message-methods
+
+// [verbose <level>(: 0 silent, 1 setup, 2 every message
+void psl_verbose(t_psl *x, t_floatarg level) {
+    x->verbose = (int)level;
+    if (x->verbose > PSL_VERBOSE) {
+        post("psl: built with PSL_VERBOSE=%d, diagnostics above it are compiled out",
+            PSL_VERBOSE);
+    }
+}
+
+// [async 0|1(: run apply and the _array families on the worker pool
+void psl_async(t_psl *x, t_floatarg f) {
+    x->async = f != 0;
+}
+
+// [errors(: post the gsl errors counted since the last report
+void psl_errors(t_psl *x) {
+    psl_errors_report("psl", x->func_name ? x->func_name->s_name : "-", &x->errors);
+}
+
+void psl_add(t_psl *x, t_floatarg f1, t_floatarg f2) {
+    outlet_float(x->out_f, f1+f2);
+}
+
+// the generator is allocated on first use and then kept for the lifetime of
+// the object, so successive calls continue the same random stream
+static gsl_rng *psl_rng(t_psl *x) {
+    if (!x->rng) {
+        x->rng = gsl_rng_alloc(x->rng_type);
+    }
+    return x->rng;
+}
+
+// the list output buffer, grown to hold at least n atoms
+static t_atom *psl_list_buffer(t_psl *x, int n) {
+    if (n > x->list_size) {
+        x->list_av = (t_atom *)resizebytes(x->list_av,
+            x->list_size * sizeof(t_atom), n * sizeof(t_atom));
+        x->list_size = n;
+    }
+    return x->list_av;
+}
+
+// the _array result buffer, grown to hold at least n values
+static double *psl_vec_buffer(t_psl *x, int n) {
+    if (n > x->vec_size) {
+        x->vec_buf = (double *)resizebytes(x->vec_buf,
+            x->vec_size * sizeof(double), n * sizeof(double));
+        x->vec_size = n;
+    }
+    return x->vec_buf;
+}
+
+// a non-zero seed restarts the stream, 0 continues it
+void psl_rando(t_psl *x, t_floatarg n, t_floatarg seed) {
+    psl_debug(x, 2, "rando: n:%.2f seed:%.2f", n, seed);
+
+    int argc = (int)n;
+    gsl_rng *r = psl_rng(x);
+
+    if (argc < 1) {
+        return;
+    }
+
+    if (seed != 0) {
+        gsl_rng_set(r, (unsigned long)seed);
+    }
+
+    t_atom *av = psl_list_buffer(x, argc);
+    for (int i = 0; i < argc; i++) {
+        SETFLOAT(av + i, gsl_rng_uniform(r));
+    }
+    outlet_list(x->out_f, &s_list, argc, av);
+}
+
+void psl_seed(t_psl *x, t_floatarg seed) {
+    gsl_rng_set(psl_rng(x), (unsigned long)seed);
+}
+
+// switch to another gsl generator by name, e.g. [type ranlxs2(
+void psl_type(t_psl *x, t_symbol *s) {
+    const gsl_rng_type **t;
+
+    for (t = gsl_rng_types_setup(); *t; t++) {
+        if (!strcmp((*t)->name, s->s_name)) {
+            break;
+        }
+    }
+    if (!*t) {
+        pd_error(x, "psl: type: no generator named '%s'", s->s_name);
+        return;
+    }
+
+    x->rng_type = *t;
+    if (x->rng) {
+        gsl_rng_free(x->rng);
+        x->rng = NULL;
+    }
+}
+
+% for f in funcs:
+% if f.name not in skip:
+% if f.nargs == 1:
+void psl_${f.name}(t_psl *x, t_floatarg f) {
+    double res;
+    PSL_COUNTING(x, res = ${f.call('f', mode='PSL_MODE(x, %s)' % f.default_mode)});
+    outlet_float(x->out_f, res);
+}
+
+% endif
+% if f.nargs == 2:
+void psl_${f.name}(t_psl *x, t_floatarg f1, t_floatarg f2) {
+    double res;
+    PSL_COUNTING(x, res = ${f.call('f1', 'f2', mode='PSL_MODE(x, %s)' % f.default_mode)});
+    outlet_float(x->out_f, res);
+}
+
+% endif
+% if f.nargs == 3:
+void psl_${f.name}(t_psl *x, t_floatarg f1, t_floatarg f2, t_floatarg f3) {
+    double res;
+    PSL_COUNTING(x, res = ${f.call('f1', 'f2', 'f3', mode='PSL_MODE(x, %s)' % f.default_mode)});
+    outlet_float(x->out_f, res);
+}
+
+% endif
+% if f.nargs > 3:
+// more arguments than pd passes as typed floats: taken as A_GIMME
+void psl_${f.name}(t_psl *x, t_symbol *s, int argc, t_atom *argv) {
+    double a[${f.nargs}];
+    for (int i = 0; i < ${f.nargs}; i++) {
+        a[i] = atom_getfloatarg(i, argc, argv);
+    }
+    double res;
+    PSL_COUNTING(x, res = ${f.call(*['a[%d]' % i for i in range(f.nargs)], mode='PSL_MODE(x, %s)' % f.default_mode)});
+    outlet_float(x->out_f, res);
+}
+
+% endif
+% endif
+% endfor
+
+
+// scalar evaluators
+//---------------------------------------------------------------------------
+
+% for f in funcs:
+% if f.has_kernel:
+static double psl_scalar_${f.name}(const double *a) {
+    return ${f.call(*['a[%d]' % i for i in range(f.nargs)])};
+}
+
+% endif
+% endfor
+
+// error-estimate evaluators
+//---------------------------------------------------------------------------
+
+% for f in funcs:
+% if f.has_e:
+static int psl_e_${f.name}(const double *a, gsl_mode_t mode, gsl_sf_result *r) {
+    % if not f.has_mode:
+    (void)mode;
+    % endif
+    return ${f.e_call(['a[%d]' % i for i in range(f.nargs)], 'mode', 'r')};
+}
+
+% endif
+% endfor
+
+// signal kernels
+//---------------------------------------------------------------------------
+
+% for f in funcs:
+% if f.has_kernel:
+static void psl_kernel_${f.name}(int n, t_sample **in, t_sample *out) {
+    % for i in range(f.nargs):
+    t_sample *in${i} = in[${i}];
+    % endfor
+    for (int i = 0; i < n; i++) {
+        out[i] = ${f.call(*['in%d[i]' % i for i in range(f.nargs)])};
+    }
+}
+
+% endif
+% endfor
+
+// vector-valued families (gsl_sf_*_array)
+//---------------------------------------------------------------------------
+
+
+typedef struct _psl_array_func {
+    const char *name;
+    int nargs;
+    int nints;                              // leading integer arguments
+    int (*size)(const double *a);           // number of results
+    int (*fill)(const double *a, double *res);
+} t_psl_array_func;
+
+
+% for f in array_funcs:
+static int psl_size_${f.name}(const double *a) {
+    % for p in f.params[:len(f.ints)]:
+    ${p}
+    % endfor
+    return ${f.size};
+}
+
+static int psl_fill_${f.name}(const double *a, double *res) {
+    % for p in f.params:
+    ${p}
+    % endfor
+    return ${f.fill};
+}
+
+% endfor
+
+static const t_psl_array_func psl_array_funcs[] = {
+    % for f in array_funcs:
+    {"${f.name}", ${f.nargs}, ${len(f.ints)}, psl_size_${f.name}, psl_fill_${f.name}},
+    % endfor
+};
+
+
+// results sent out as a list or written to the array dst (up to its size)
+static void psl_array_output(t_psl *x, const double *res, int n, t_symbol *dst) {
+    if (dst) {
+        t_garray *ga;
+        int size;
+        t_word *vec = psl_getarray(x, dst, &size, &ga);
+        if (!vec) {
+            return;
+        }
+        for (int i = 0; i < n && i < size; i++) {
+            vec[i].w_float = res[i];
+        }
+        garray_redraw(ga);
+    } else {
+        t_atom *av = psl_list_buffer(x, n);
+        for (int i = 0; i < n; i++) {
+            SETFLOAT(av + i, res[i]);
+        }
+        outlet_list(x->out_f, &s_list, n, av);
+    }
+}
+
+
+static void psl_array_work(t_psl_job *job) {
+    const t_psl_array_func *f = (const t_psl_array_func *)job->func;
+    job->status = f->fill(job->args, job->data);
+}
+
+
+static void psl_array_done(t_psl *x, t_psl_job *job) {
+    const t_psl_array_func *f = (const t_psl_array_func *)job->func;
+    if (job->status) {
+        pd_error(x, "psl: %s: %s", f->name, gsl_strerror(job->status));
+        return;
+    }
+    psl_array_output(x, job->data, job->n, job->dst);
+}
+
+
+// one GSL call for the whole sequence, on the pool with -async
+static void psl_array_run(t_psl *x, const t_psl_array_func *f,
+                          const double *a, t_symbol *dst) {
+    for (int i = 0; i < f->nints; i++) {
+        if (a[i] < 0) {
+            pd_error(x, "psl: %s: integer arguments must be >= 0", f->name);
+            return;
+        }
+    }
+
+    int n = f->size(a);
+    if (n < 1 || n > ARRAY_MAX_SIZE) {
+        pd_error(x, "psl: %s: bad result size %d", f->name, n);
+        return;
+    }
+
+    if (x->async) {
+        t_psl_job *job = psl_job_new(f, n);
+        memcpy(job->args, a, f->nargs * sizeof(double));
+        job->dst = dst;
+        job->work = psl_array_work;
+        job->done = psl_array_done;
+        psl_job_run(x, job);
+        return;
+    }
+
+    double *res = psl_vec_buffer(x, n);
+    int status;
+    PSL_COUNTING(x, status = f->fill(a, res));
+    if (status) {
+        pd_error(x, "psl: %s: %s", f->name, gsl_strerror(status));
+        return;
+    }
+    psl_array_output(x, res, n, dst);
+}
+
+
+// [<family>_array <args...> [array](
+static void psl_array_message(t_psl *x, const t_psl_array_func *f,
+                              int argc, t_atom *argv) {
+    double a[MAX_ARGS];
+    t_symbol *dst = NULL;
+
+    if (argc == f->nargs + 1 && argv[f->nargs].a_type == A_SYMBOL) {
+        dst = argv[f->nargs].a_w.w_symbol;
+    } else if (argc != f->nargs) {
+        pd_error(x, "psl: %s needs %d arguments and optionally an array name",
+            f->name, f->nargs);
+        return;
+    }
+
+    for (int i = 0; i < f->nargs; i++) {
+        a[i] = atom_getfloatarg(i, argc, argv);
+    }
+    psl_array_run(x, f, a, dst);
+}
+
+
+% for f in array_funcs:
+void psl_${f.name}(t_psl *x, t_symbol *s, int argc, t_atom *argv) {
+    psl_array_message(x, &psl_array_funcs[${loop.index}], argc, argv);
+}
+
+static void psl_call_${f.name}(t_psl *x, const double *a) {
+    psl_array_run(x, &psl_array_funcs[${loop.index}], a, NULL);
+}
+
+% endfor
+
+// function selection
+//---------------------------------------------------------------------------
+
+
+struct _psl_func {
+    const char *name;
+    int nargs;
+    t_psl_call call;     // object evaluator
+    t_psl_kernel kernel; // NULL if there is no signal version
+    t_psl_scalar scalar; // NULL if there is no signal version
+    t_psl_efunc efunc;   // NULL if there is no _e form
+    gsl_mode_t mode;     // default precision
+    int moded;           // takes a gsl_mode_t, so a precision applies
+    t_symbol *sym;       // interned name, set in psl_setup
+};
+
+
+// object evaluators for psl_funcs: the scalar evaluator where there is one
+
+static void psl_call_scalar(t_psl *x, const double *args) {
+    outlet_float(x->out_f, x->func->scalar(args));
+}
+
+static void psl_call_rando(t_psl *x, const double *args) {
+    psl_rando(x, args[0], args[1]);
+}
+
+// one value through the _e form. An underflow still has a valid value, 0 as
+// from the plain function; other failures give NaN. The status, if any, is
+// left in *status.
+static double psl_e_value(const t_psl_func *f, const double *args, gsl_mode_t mode,
+        double *err, int *status) {
+    gsl_sf_result r;
+
+    int s = f->efunc(args, mode, &r);
+    if (s) {
+        *status = s;
+        if (s != GSL_EUNDRFLW) {
+            *err = NAN;
+            return NAN;
+        }
+    }
+    *err = r.err;
+    return r.val;
+}
+
+
+// the _e form at the object's precision, the error estimate to the right;
+// a failing status goes out there as [status <gsl_errno>( instead
+static void psl_call_e(t_psl *x, const double *args) {
+    double err;
+    int status = 0;
+
+    double val = psl_e_value(x->func, args, PSL_MODE(x, x->func->mode), &err, &status);
+    if (status) {
+        psl_debug(x, 1, "psl: %s: %s", x->func->name, gsl_strerror(status));
+        if (x->out_err) {
+            t_atom a;
+            SETFLOAT(&a, status);
+            outlet_anything(x->out_err, gensym("status"), 1, &a);
+        }
+    } else if (x->out_err) {
+        outlet_float(x->out_err, err);
+    }
+    outlet_float(x->out_f, val);
+}
+
+
+// in perfect hash slot order
+static t_psl_func psl_funcs[N_FUNCS] = {
+    % for f in phash.slots:
+    {"${f.name}", ${f.nargs}, ${f.caller}, ${'psl_kernel_' + f.name if f.has_kernel else 'NULL'}, ${'psl_scalar_' + f.name if f.has_kernel else 'NULL'}, ${'psl_e_' + f.name if f.has_e else 'NULL'}, ${f.default_mode}, ${1 if f.has_mode else 0}, NULL},
+    % endfor
+};
+
+
+// O(1) lookup: one probe, then an interned symbol pointer comparison
+static t_psl_func *psl_lookup(t_symbol *s) {
+    uint32_t d = psl_func_disp[psl_hash(s->s_name, 0) % N_FUNCS];
+    t_psl_func *f = &psl_funcs[psl_hash(s->s_name, d) % N_FUNCS];
+    return (f->sym == s) ? f : NULL;
+}
+
+
+// set default function from symbol
+void select_default_function(t_psl *x, t_symbol *s) {
+    x->func_name = s;
+    psl_debug(x, 1, "func %s selected", s->s_name);
+
+    t_psl_func *f = psl_lookup(s);
+    if (!f) {
+        // [psl] alone selects nothing, a misspelt name should say so
+        if (s != &s_) {
+            pd_error(x, "psl: no function named '%s'", s->s_name);
+        }
+        return;
+    }
+
+    x->func = f;
+    x->nargs = f->nargs;
+    x->call = f->call;
+}
+
+
+// chebyshev approximation of unary functions
+//---------------------------------------------------------------------------
+
+
+static double psl_cheb_func(double x, void *params) {
+    return ((t_psl_func *)params)->scalar(&x);
+}
+
+
+static gsl_cheb_series *psl_cheb_build(const char *cls, t_psl_func *f,
+                                       t_float lo, t_float hi, int order) {
+    if (!f->scalar || f->nargs != 1 || order < 1 || !(hi > lo)) {
+        pd_error(0, "%s %s: -cheb needs a unary function, lo < hi and order >= 1",
+            cls, f->name);
+        return NULL;
+    }
+
+    gsl_cheb_series *cs = gsl_cheb_alloc(order);
+    gsl_function F = {psl_cheb_func, f};
+
+    gsl_cheb_init(cs, &F, lo, hi);
+
+    // same estimate as gsl_cheb_eval_err: the size of the last coefficient
+    post("%s %s: order %d chebyshev series over [%g, %g], error estimate %g",
+        cls, f->name, order, lo, hi, fabs(gsl_cheb_coeffs(cs)[order]));
+
+    return cs;
+}
+
+
+static void psl_call_cheb(t_psl *x, const double *args) {
+    double lo = x->cheb->a, hi = x->cheb->b;
+    double in = args[0] < lo ? lo : (args[0] > hi ? hi : args[0]);
+
+    if (x->out_err) {
+        double val, err;
+        gsl_cheb_eval_err(x->cheb, in, &val, &err);
+        outlet_float(x->out_err, err);
+        outlet_float(x->out_f, val);
+        return;
+    }
+    outlet_float(x->out_f, gsl_cheb_eval(x->cheb, in));
+}
+
+
+// the accumulator keeps the last `window` values and drops the oldest on
+// insert; mean to median update in place, the robust scales sort the window
+static double psl_movstat_get(t_psl_movstat *m) {
+    double res[2];
+
+    m->accum->get(m->params, res, m->state);
+    return res[m->two];
+}
+
+
+static double psl_movstat_push(t_psl_movstat *m, double in) {
+    m->accum->insert(in, m->state);
+    m->count++;
+    return psl_movstat_get(m);
+}
+
+
+static void psl_call_movstat(t_psl *x, const double *args) {
+    outlet_float(x->out_f, psl_movstat_push(x->movstat, args[0]));
+}
+
+
+// precision and error estimates
+//---------------------------------------------------------------------------
+
+
+// gsl_mode_t for a precision name, -1 for `default`, -2 if unknown
+static int psl_mode_from(t_symbol *s) {
+    if (s == gensym("double")) return GSL_PREC_DOUBLE;
+    if (s == gensym("single")) return GSL_PREC_SINGLE;
+    if (s == gensym("approx")) return GSL_PREC_APPROX;
+    if (s == gensym("default")) return -1;
+    return -2;
+}
+
+
+// the plain evaluator is fastest; the _e form is used once a precision is
+// chosen for a function taking one, or the error estimate is wanted
+static void psl_update_call(t_psl *x) {
+    if (!x->func || x->cheb) {
+        return;
+    }
+    if (x->func->efunc && ((x->func->moded && x->mode >= 0) || x->out_err)) {
+        x->call = psl_call_e;
+    } else {
+        x->call = x->func->call;
+    }
+}
+
+
+// [precision double|single|approx|default(
+void psl_precision(t_psl *x, t_symbol *s) {
+    int mode = psl_mode_from(s);
+    if (mode < -1) {
+        pd_error(x, "psl: precision: expected double, single, approx or default");
+        return;
+    }
+    if (mode >= 0 && x->func && !x->func->moded) {
+        pd_error(x, "psl %s: precision: the function takes no gsl_mode_t", x->func->name);
+        return;
+    }
+    x->mode = mode;
+    psl_update_call(x);
+}
+
+
+// list methods
+//---------------------------------------------------------------------------
+
+
+// [map v0 v1 ...(: evaluate the function on each value and output one list.
+// The values go to the first argument; any others keep their inlet values.
+// With -err, the error estimates go out to the right as a list as well.
+void psl_map(t_psl *x, t_symbol *s, int argc, t_atom *argv) {
+    t_psl_func *f = x->func;
+
+    if (!x->expr && !x->cheb && !x->movstat) {
+        if (!f || !f->scalar) {
+            pd_error(x, "psl: map: no list function named '%s'", x->func_name->s_name);
+            return;
+        }
+    }
+
+    t_atom *av = psl_list_buffer(x, 2 * argc);
+    double *args = x->arg_array;
+    int status = 0;
+
+    // PSL_COUNTING, spread over the three loops
+    t_psl_errors *prev = psl_errors_current;
+    psl_errors_current = &x->errors;
+    if (x->expr) {
+        for (int i = 0; i < argc; i++) {
+            args[0] = atom_getfloat(argv + i);
+            SETFLOAT(av + i, te_eval_program(x->expr));
+        }
+    } else if (x->cheb) {
+        double lo = x->cheb->a, hi = x->cheb->b;
+        for (int i = 0; i < argc; i++) {
+            double in = atom_getfloat(argv + i);
+            in = in < lo ? lo : (in > hi ? hi : in);
+            SETFLOAT(av + i, gsl_cheb_eval(x->cheb, in));
+        }
+    } else if (x->movstat) {
+        for (int i = 0; i < argc; i++) {
+            SETFLOAT(av + i, psl_movstat_push(x->movstat, atom_getfloat(argv + i)));
+        }
+    } else if (x->call == psl_call_e) {
+        gsl_mode_t mode = PSL_MODE(x, f->mode);
+        for (int i = 0; i < argc; i++) {
+            double err;
+            args[0] = atom_getfloat(argv + i);
+            SETFLOAT(av + i, psl_e_value(f, args, mode, &err, &status));
+            SETFLOAT(av + argc + i, err);
+        }
+    } else {
+        for (int i = 0; i < argc; i++) {
+            args[0] = atom_getfloat(argv + i);
+            SETFLOAT(av + i, f->scalar(args));
+        }
+    }
+    psl_errors_current = prev;
+
+    if (x->out_err && x->call == psl_call_e) {
+        if (status) {
+            t_atom a;
+            SETFLOAT(&a, status);
+            outlet_anything(x->out_err, gensym("status"), 1, &a);
+        }
+        outlet_list(x->out_err, &s_list, argc, av + argc);
+    }
+    outlet_list(x->out_f, &s_list, argc, av);
+}
+
+
+// array methods
+//---------------------------------------------------------------------------
+
+
+static t_word *psl_getarray(void *x, t_symbol *s, int *n, t_garray **ga) {
+    t_word *vec;
+
+    if (!(*ga = (t_garray *)pd_findbyclass(s, garray_class))) {
+        pd_error(x, "psl: %s: no such array", s->s_name);
+        return NULL;
+    }
+    if (!garray_getfloatwords(*ga, n, &vec)) {
+        pd_error(x, "psl: %s: bad template for psl", s->s_name);
+        return NULL;
+    }
+    return vec;
+}
+
+
+// the _e form over n values in place, for a precision or error estimates;
+// returns the largest estimate, and the last failing status in *status
+static double psl_apply_e(const t_psl_func *f, gsl_mode_t mode, double *args,
+        double *data, int n, int *status) {
+    double max = 0;
+
+    for (int j = 0; j < n; j++) {
+        double err;
+        args[0] = data[j];
+        data[j] = psl_e_value(f, args, mode, &err, status);
+        max = err > max ? err : max;
+    }
+    return max;
+}
+
+
+// after apply with -err: the status of a failure, then the largest estimate
+static void psl_apply_report(t_psl *x, int status, double err) {
+    if (status) {
+        t_atom a;
+        SETFLOAT(&a, status);
+        outlet_anything(x->out_err, gensym("status"), 1, &a);
+    }
+    outlet_float(x->out_err, err);
+}
+
+
+// the kernel over job->data in place, the other arguments held constant
+static void psl_apply_work(t_psl_job *job) {
+    const t_psl_func *f = (const t_psl_func *)job->func;
+    t_sample buf[MAX_ARGS][APPLY_CHUNK];
+    t_sample *ins[MAX_ARGS];
+    t_sample out[APPLY_CHUNK];
+
+    if (job->mode >= 0) {
+        job->err = psl_apply_e(f, (gsl_mode_t)job->mode, job->args, job->data,
+            job->n, &job->status);
+        return;
+    }
+
+    for (int k = 0; k < f->nargs; k++) {
+        ins[k] = buf[k];
+        for (int j = 0; k > 0 && j < APPLY_CHUNK; j++) {
+            buf[k][j] = job->args[k];
+        }
+    }
+
+    for (int start = 0; start < job->n; start += APPLY_CHUNK) {
+        int m = job->n - start < APPLY_CHUNK ? job->n - start : APPLY_CHUNK;
+        for (int j = 0; j < m; j++) {
+            buf[0][j] = job->data[start + j];
+        }
+        f->kernel(m, ins, out);
+        for (int j = 0; j < m; j++) {
+            job->data[start + j] = out[j];
+        }
+    }
+}
+
+
+// the destination is looked up again: it may have been resized meanwhile
+static void psl_apply_done(t_psl *x, t_psl_job *job) {
+    t_garray *ga;
+    int size;
+    t_word *vec = psl_getarray(x, job->dst, &size, &ga);
+    if (!vec) {
+        return;
+    }
+    for (int j = 0; j < job->n && j < size; j++) {
+        vec[j].w_float = job->data[j];
+    }
+    garray_redraw(ga);
+    if (x->out_err && job->mode >= 0) {
+        psl_apply_report(x, job->status, job->err);
+    }
+}
+
+
+// [apply <func> <src> [<dst>] [<arg2> ...](
+// runs the signal kernel of <func> over the whole of <src> in chunks, with
+// any further arguments held constant, and writes to <dst> (or in place).
+// With a precision or -err it runs the _e form instead, and -err sends the
+// largest error estimate over the array.
+void psl_apply(t_psl *x, t_symbol *s, int argc, t_atom *argv) {
+    t_sample buf[MAX_ARGS][APPLY_CHUNK];
+    t_sample *ins[MAX_ARGS];
+    t_garray *src_ga, *dst_ga;
+    t_word *src, *dst;
+    int n_src, n_dst, i = 2;
+
+    t_symbol *name = atom_getsymbolarg(0, argc, argv);
+    t_psl_func *f = psl_lookup(name);
+    if (!f || !f->kernel) {
+        pd_error(x, "psl: apply: no array function named '%s'", name->s_name);
+        return;
+    }
+
+    t_symbol *dst_name = atom_getsymbolarg(1, argc, argv);
+    if (!(src = psl_getarray(x, dst_name, &n_src, &src_ga))) {
+        return;
+    }
+    dst = src, dst_ga = src_ga, n_dst = n_src;
+    if (argc > 2 && argv[2].a_type == A_SYMBOL) {
+        dst_name = atom_getsymbolarg(2, argc, argv);
+        if (!(dst = psl_getarray(x, dst_name, &n_dst, &dst_ga))) {
+            return;
+        }
+        i++;
+    }
+
+    if (argc - i != f->nargs - 1) {
+        pd_error(x, "psl: apply: %s needs %d constant argument(s)", f->name, f->nargs - 1);
+        return;
+    }
+
+    int mode = -1;
+    if (f->efunc && ((f->moded && x->mode >= 0) || x->out_err)) {
+        mode = PSL_MODE(x, f->mode);
+    }
+
+    if (x->async) {
+        t_psl_job *job = psl_job_new(f, n_src < n_dst ? n_src : n_dst);
+        for (int k = 1; k < f->nargs; k++) {
+            job->args[k] = atom_getfloatarg(i + k - 1, argc, argv);
+        }
+        job->mode = mode;
+        for (int j = 0; j < job->n; j++) {
+            job->data[j] = src[j].w_float;
+        }
+        job->dst = dst_name;
+        job->work = psl_apply_work;
+        job->done = psl_apply_done;
+        psl_job_run(x, job);
+        return;
+    }
+
+    int n = n_src < n_dst ? n_src : n_dst;
+
+    if (mode >= 0) {
+        double args[MAX_ARGS];
+        double *data = psl_vec_buffer(x, n);
+        int status = 0;
+        double err;
+        for (int k = 1; k < f->nargs; k++) {
+            args[k] = atom_getfloatarg(i + k - 1, argc, argv);
+        }
+        for (int j = 0; j < n; j++) {
+            data[j] = src[j].w_float;
+        }
+        PSL_COUNTING(x, err = psl_apply_e(f, (gsl_mode_t)mode, args, data, n, &status));
+        for (int j = 0; j < n; j++) {
+            dst[j].w_float = data[j];
+        }
+        garray_redraw(dst_ga);
+        if (x->out_err) {
+            psl_apply_report(x, status, err);
+        }
+        return;
+    }
+
+    for (int k = 0; k < f->nargs; k++) {
+        ins[k] = buf[k];
+    }
+    for (int k = 1; k < f->nargs; k++) {
+        t_sample v = atom_getfloatarg(i + k - 1, argc, argv);
+        for (int j = 0; j < APPLY_CHUNK; j++) {
+            buf[k][j] = v;
+        }
+    }
+
+    t_sample out[APPLY_CHUNK];
+    for (int start = 0; start < n; start += APPLY_CHUNK) {
+        int m = n - start < APPLY_CHUNK ? n - start : APPLY_CHUNK;
+        for (int j = 0; j < m; j++) {
+            buf[0][j] = src[start + j].w_float;
+        }
+        f->kernel(m, ins, out);
+        for (int j = 0; j < m; j++) {
+            dst[start + j].w_float = out[j];
+        }
+    }
+
+    garray_redraw(dst_ga);
+}
+
+
+// discrete hankel transform
+//---------------------------------------------------------------------------
+
+
+// the bessel zeros are computed when the plan is made, which costs far more
+// than a transform, so the plan is kept and only rebuilt when it changes
+static int psl_dht_plan(t_psl *x, int size, double nu, double xmax) {
+    if (size < 1 || nu < 0 || !(xmax > 0)) {
+        pd_error(x, "psl dht: needs size >= 1, order >= 0 and xmax > 0");
+        return 0;
+    }
+
+    gsl_dht *t = x->dht;
+    if (t && (int)t->size == size && t->nu == nu && t->xmax == xmax) {
+        return 1;
+    }
+
+    // a failed plan leaves the current one in place
+    int status = 0;
+    PSL_COUNTING(x, t = gsl_dht_alloc(size));
+    if (t) {
+        PSL_COUNTING(x, status = gsl_dht_init(t, nu, xmax));
+    }
+    if (!t || status) {
+        pd_error(x, "psl dht: %s", status ? gsl_strerror(status) : "could not make the plan");
+        if (t) {
+            gsl_dht_free(t);
+        }
+        return 0;
+    }
+
+    if (!x->dht || (int)x->dht->size != size) {
+        if (x->dht) {
+            freebytes(x->dht_buf, 2 * x->dht->size * sizeof(double));
+        }
+        x->dht_buf = (double *)getbytes(2 * size * sizeof(double));
+    }
+    if (x->dht) {
+        gsl_dht_free(x->dht);
+    }
+    x->dht = t;
+    return 1;
+}
+
+
+// [plan <size> <order> <xmax>(
+void psl_dht_replan(t_psl *x, t_floatarg size, t_floatarg nu, t_floatarg xmax) {
+    if (!x->dht) {
+        pd_error(x, "psl: plan: only for [psl dht ...]");
+        return;
+    }
+    psl_dht_plan(x, (int)size, nu, xmax);
+}
+
+
+// [dht <src> [<dst>](: transform the first `size` points of src, into dst
+// or back into src
+void psl_dht(t_psl *x, t_symbol *src, t_symbol *dst) {
+    t_garray *ga;
+    int n;
+    t_word *vec;
+
+    if (!x->dht) {
+        pd_error(x, "psl: dht: create the object as [psl dht <size> <order> <xmax>]");
+        return;
+    }
+    if (!(vec = psl_getarray(x, src, &n, &ga))) {
+        return;
+    }
+
+    int size = x->dht->size;
+    double *in = x->dht_buf, *out = x->dht_buf + size;
+    for (int i = 0; i < size; i++) {
+        in[i] = i < n ? vec[i].w_float : 0;
+    }
+
+    int status;
+    PSL_COUNTING(x, status = gsl_dht_apply(x->dht, in, out));
+    if (status) {
+        pd_error(x, "psl: dht: %s", gsl_strerror(status));
+        return;
+    }
+
+    if (dst != &s_ && !(vec = psl_getarray(x, dst, &n, &ga))) {
+        return;
+    }
+    for (int i = 0; i < size && i < n; i++) {
+        vec[i].w_float = out[i];
+    }
+    garray_redraw(ga);
+}
+
+
+// [samples <array> [k](: the x sample points of the plan, or the k points
+void psl_dht_samples(t_psl *x, t_symbol *s, t_floatarg k) {
+    t_garray *ga;
+    int n;
+    t_word *vec;
+
+    if (!x->dht) {
+        pd_error(x, "psl: samples: only for [psl dht ...]");
+        return;
+    }
+    if (!(vec = psl_getarray(x, s, &n, &ga))) {
+        return;
+    }
+    for (int i = 0; i < (int)x->dht->size && i < n; i++) {
+        vec[i].w_float = k != 0 ? gsl_dht_k_sample(x->dht, i) : gsl_dht_x_sample(x->dht, i);
+    }
+    garray_redraw(ga);
+}
+
+
+// [psl dht <size> <order> <xmax>]
+static int psl_dht_init(t_psl *x, int argc, t_atom *argv) {
+    if (!psl_dht_plan(x, (int)atom_getfloatarg(0, argc, argv),
+            atom_getfloatarg(1, argc, argv), atom_getfloatarg(2, argc, argv))) {
+        return 0;
+    }
+    x->func_name = gensym("dht");
+    return 1;
+}
+
+
+// moving window statistics
+//---------------------------------------------------------------------------
+
+
+// gsl has no moving quantile; the window arrives as a copy, sorted here
+static double psl_movstat_quantile(const size_t n, double v[], void *params) {
+    gsl_sort(v, 1, n);
+    return gsl_stats_quantile_from_sorted_data(v, 1, n, *(double *)params);
+}
+
+
+// the accumulator for a statistic name, 0 if unknown
+static int psl_movstat_select(t_psl_movstat *m, t_symbol *s, double param) {
+    m->params = NULL;
+    m->two = 0;
+    if (s == gensym("mean")) {
+        m->accum = gsl_movstat_accum_mean;
+    } else if (s == gensym("variance")) {
+        m->accum = gsl_movstat_accum_variance;
+    } else if (s == gensym("sd")) {
+        m->accum = gsl_movstat_accum_sd;
+    } else if (s == gensym("sum")) {
+        m->accum = gsl_movstat_accum_sum;
+    } else if (s == gensym("min")) {
+        m->accum = gsl_movstat_accum_min;
+    } else if (s == gensym("max")) {
+        m->accum = gsl_movstat_accum_max;
+    } else if (s == gensym("median")) {
+        m->accum = gsl_movstat_accum_median;
+    } else if (s == gensym("mad") || s == gensym("mad0")) {
+        // scaled to estimate the standard deviation of gaussian data, as
+        // gsl_movstat_mad does; mad0 is the raw median absolute deviation
+        m->accum = gsl_movstat_accum_mad;
+        m->param = s == gensym("mad") ? 1.482602218505602 : 1.0;
+        m->params = &m->param;
+        m->two = 1;
+    } else if (s == gensym("qn")) {
+        m->accum = gsl_movstat_accum_Qn;
+    } else if (s == gensym("sn")) {
+        m->accum = gsl_movstat_accum_Sn;
+    } else if (s == gensym("qqr") || s == gensym("quantile")) {
+        if (!(param >= 0 && param <= (s == gensym("qqr") ? 0.5 : 1))) {
+            return 0;
+        }
+        m->param = param;
+        if (s == gensym("qqr")) {
+            m->accum = gsl_movstat_accum_qqr;
+            m->params = &m->param;
+        } else {
+            m->func.function = psl_movstat_quantile;
+            m->func.params = &m->param;
+            m->accum = gsl_movstat_accum_userfunc;
+            m->params = &m->func;
+        }
+    } else {
+        return 0;
+    }
+    return 1;
+}
+
+
+static void psl_movstat_free(t_psl_movstat *m) {
+    if (m->work) {
+        gsl_movstat_free(m->work);
+    }
+    freebytes(m->state, m->accum->size(m->window));
+    freebytes(m, sizeof(*m));
+}
+
+
+// [reset(: forget the values streamed so far
+void psl_movstat_reset(t_psl *x) {
+    if (!x->movstat) {
+        pd_error(x, "psl: reset: only for [psl movstat ...]");
+        return;
+    }
+    x->movstat->accum->init(x->movstat->window, x->movstat->state);
+    x->movstat->count = 0;
+}
+
+
+// [bang(: the statistic over the window as it is, nothing added
+static void psl_movstat_bang(t_psl *x) {
+    if (!x->movstat->count) {
+        psl_debug(x, 1, "psl movstat: the window is empty");
+        return;
+    }
+    double v;
+    PSL_COUNTING(x, v = psl_movstat_get(x->movstat));
+    outlet_float(x->out_f, v);
+}
+
+
+// [movstat <src> [<dst>](: the statistic over a window centred on each point
+// of src, into dst or back into src. The ends are padded with the first and
+// last values.
+void psl_movstat(t_psl *x, t_symbol *src, t_symbol *dst) {
+    t_psl_movstat *m = x->movstat;
+    t_garray *ga;
+    int n;
+    t_word *vec;
+
+    if (!m) {
+        pd_error(x, "psl: movstat: create the object as [psl movstat <stat> <window>]");
+        return;
+    }
+    if (!(vec = psl_getarray(x, src, &n, &ga)) || n < 1) {
+        return;
+    }
+    if (!m->work) {
+        int h = m->window / 2;
+        PSL_COUNTING(x, m->work = gsl_movstat_alloc_with_size(
+            m->accum->size(m->window), h, m->window - 1 - h));
+        if (!m->work) {
+            pd_error(x, "psl: movstat: could not allocate the workspace");
+            return;
+        }
+    }
+
+    double *buf = psl_vec_buffer(x, 3 * n);
+    gsl_vector_view in = gsl_vector_view_array(buf, n);
+    gsl_vector_view y = gsl_vector_view_array(buf + n, n);
+    gsl_vector_view z = gsl_vector_view_array(buf + 2 * n, n);
+    for (int i = 0; i < n; i++) {
+        buf[i] = vec[i].w_float;
+    }
+
+    int status;
+    PSL_COUNTING(x, status = gsl_movstat_apply_accum(GSL_MOVSTAT_END_PADVALUE,
+        &in.vector, m->accum, m->params, &y.vector, m->two ? &z.vector : NULL, m->work));
+    if (status) {
+        pd_error(x, "psl: movstat: %s", gsl_strerror(status));
+        return;
+    }
+
+    if (dst != &s_ && !(vec = psl_getarray(x, dst, &n, &ga))) {
+        return;
+    }
+    double *out = m->two ? z.vector.data : y.vector.data;
+    for (int i = 0; i < n && i < (int)in.vector.size; i++) {
+        vec[i].w_float = out[i];
+    }
+    garray_redraw(ga);
+}
+
+
+// [psl movstat <stat> <window> [<q>]]
+static int psl_movstat_init(t_psl *x, int argc, t_atom *argv) {
+    t_symbol *stat = atom_getsymbolarg(0, argc, argv);
+    int window = (int)atom_getfloatarg(1, argc, argv);
+    t_psl_movstat *m = (t_psl_movstat *)getbytes(sizeof(*m));
+
+    if (!psl_movstat_select(m, stat, atom_getfloatarg(2, argc, argv))) {
+        pd_error(x, "psl movstat: unknown statistic '%s' or bad parameter", stat->s_name);
+        freebytes(m, sizeof(*m));
+        return 0;
+    }
+    if (window < 1) {
+        pd_error(x, "psl movstat: needs a window of at least 1 value");
+        freebytes(m, sizeof(*m));
+        return 0;
+    }
+    m->window = window;
+    m->state = getbytes(m->accum->size(window));
+    m->accum->init(window, m->state);
+    m->count = 0;
+    m->work = NULL;
+
+    x->movstat = m;
+    x->nargs = 1;
+    x->call = psl_call_movstat;
+    x->func_name = gensym("movstat");
+    return 1;
+}
+
+
+// psl-inlet funcs
+// ---------------------------------------------------------------------------
+
+
+static void psl_inlet_float(t_psl_inlet *x, float f)
+{
+    x->owner->arg_array[x->id+1] = f;
+    // outlet_float(x->owner->out_f, x->id + f);
+    psl_debug(x->owner, 2, "x->owner->arg_array[x->id]: %.02f", x->owner->arg_array[x->id+1]);
+    psl_eval(x->owner);
+}
+
+
+// psl class constructor
+// ---------------------------------------------------------------------------
+
+
+// [psl [<func> [-cheb <lo> <hi> <order>] [-prec <mode>] [-err] [-async]]]
+// [psl expr <expression>], [psl dht <size> <order> <xmax>]
+// [psl movstat <stat> <window> [<q>]]
+void *psl_new(t_symbol *s, int argc, t_atom *argv) {
+    t_psl *x = (t_psl *)pd_new(psl_class);
+
+    // initialize variables
+    x->nargs = 0;
+    x->verbose = PSL_VERBOSE;
+    x->inlets = 0;
+    x->func = NULL;
+    x->call = NULL;
+    x->mode = -1;
+    psl_errors_init(&x->errors);
+    x->async = 0;
+    x->out_err = NULL;
+    x->cheb = NULL;
+    x->dht = NULL;
+    x->dht_buf = NULL;
+    x->movstat = NULL;
+    x->rng_type = gsl_rng_mt19937;
+    x->rng = NULL;
+    x->list_av = (t_atom *)getbytes(LIST_PREALLOC * sizeof(t_atom));
+    x->list_size = LIST_PREALLOC;
+    x->vec_buf = NULL;
+    x->vec_size = 0;
+    x->expr = NULL;
+    x->arg_array = (double *)getbytes(MAX_ARGS * sizeof(*x->arg_array));
+
+    if (atom_getsymbolarg(0, argc, argv) == gensym("expr")) {
+        if (!psl_expr_init(x, argc - 1, argv + 1)) {
+            pd_free((t_pd *)x);
+            return NULL;
+        }
+    } else if (atom_getsymbolarg(0, argc, argv) == gensym("dht")) {
+        if (!psl_dht_init(x, argc - 1, argv + 1)) {
+            pd_free((t_pd *)x);
+            return NULL;
+        }
+    } else if (atom_getsymbolarg(0, argc, argv) == gensym("movstat")) {
+        if (!psl_movstat_init(x, argc - 1, argv + 1)) {
+            pd_free((t_pd *)x);
+            return NULL;
+        }
+    } else {
+        select_default_function(x, atom_getsymbolarg(0, argc, argv));
+        // sets x->nargs to correct number
+    }
+
+    int err = 0;
+    for (int i = 1; i < argc && x->func; i++) {
+        t_symbol *flag = atom_getsymbolarg(i, argc, argv);
+        if (flag == gensym("-cheb") && i + 3 < argc) {
+            x->cheb = psl_cheb_build("psl", x->func,
+                atom_getfloatarg(i + 1, argc, argv),
+                atom_getfloatarg(i + 2, argc, argv),
+                (int)atom_getfloatarg(i + 3, argc, argv));
+            if (x->cheb) {
+                x->call = psl_call_cheb;
+            }
+            i += 3;
+        } else if (flag == gensym("-prec") && i + 1 < argc) {
+            int mode = psl_mode_from(atom_getsymbolarg(i + 1, argc, argv));
+            if (mode < -1) {
+                pd_error(x, "psl %s: -prec expects double, single or approx", x->func->name);
+            } else if (mode >= 0 && !x->func->moded) {
+                pd_error(x, "psl %s: -prec: the function takes no gsl_mode_t", x->func->name);
+            } else {
+                x->mode = mode;
+            }
+            i += 1;
+        } else if (flag == gensym("-err")) {
+            err = 1;
+        } else if (flag == gensym("-async")) {
+            x->async = 1;
+        } else {
+            pd_error(x, "psl %s: bad argument at position %d", x->func->name, i);
+        }
+    }
+
+    // create inlets
+    x->inlets = x->nargs > 0 ? x->nargs - 1 : 0;
+    x->ins = (t_psl_inlet *)getbytes(x->inlets * sizeof(*x->ins));
+
+    for (int i=0; i < x->inlets; i++) {
+        x->ins[i].x_pd = psl_inlet_class;
+        x->ins[i].owner = x;
+        x->ins[i].id = i;
+        inlet_new((t_object *)x, &(x->ins[i].x_pd), 0, 0);
+    }
+
+
+    // initialize outlets
+    x->out_f = outlet_new(&x->x_obj, &s_float);
+    if (err) {
+        if (x->cheb || x->func->efunc) {
+            x->out_err = outlet_new(&x->x_obj, &s_float);
+        } else {
+            pd_error(x, "psl %s: no error estimate available", x->func->name);
+        }
+    }
+    psl_update_call(x);
+
+    return (void *)x;
+}
+
+
+// psl class destructor
+// ---------------------------------------------------------------------------
+
+
+void psl_free(t_psl *x) {
+    freebytes(x->arg_array, MAX_ARGS * sizeof(*x->arg_array));
+    freebytes(x->ins, x->inlets * sizeof(*x->ins));
+    if (x->expr) {
+        te_free_program(x->expr);
+    }
+    if (x->cheb) {
+        gsl_cheb_free(x->cheb);
+    }
+    if (x->dht) {
+        freebytes(x->dht_buf, 2 * x->dht->size * sizeof(double));
+        gsl_dht_free(x->dht);
+    }
+    if (x->movstat) {
+        psl_movstat_free(x->movstat);
+    }
+    if (x->rng) {
+        gsl_rng_free(x->rng);
+    }
+    freebytes(x->list_av, x->list_size * sizeof(t_atom));
+    freebytes(x->vec_buf, x->vec_size * sizeof(double));
+    psl_pool_forget(x);
+}
+
+
+// FFT plans
+// ---------------------------------------------------------------------------
+
+
+// wavetables and workspace for one size, shared by all psl.fft and psl~ conv
+// objects and kept until the last of them is freed. psl.fft transforms a
+// double copy of its array, which is kept with the plan as well.
+typedef struct _psl_fft_plan {
+    size_t n;
+    gsl_fft_real_wavetable *real;
+    gsl_fft_halfcomplex_wavetable *hc;
+    gsl_fft_real_workspace *work;
+    double *buf;
+    struct _psl_fft_plan *next;
+} t_psl_fft_plan;
+
+
+static t_psl_fft_plan *psl_fft_plans;
+static int psl_fft_users;       // live psl.fft and psl~ conv objects
+
+
+static t_psl_fft_plan *psl_fft_plan(size_t n) {
+    t_psl_fft_plan *p;
+
+    for (p = psl_fft_plans; p; p = p->next) {
+        if (p->n == n) {
+            return p;
+        }
+    }
+
+    p = (t_psl_fft_plan *)getbytes(sizeof(*p));
+    p->n = n;
+    p->real = gsl_fft_real_wavetable_alloc(n);
+    p->hc = gsl_fft_halfcomplex_wavetable_alloc(n);
+    p->work = gsl_fft_real_workspace_alloc(n);
+    p->buf = (double *)getbytes(n * sizeof(double));
+    p->next = psl_fft_plans;
+    psl_fft_plans = p;
+    return p;
+}
+
+
+// called as an object stops using plans
+static void psl_fft_release(void) {
+    if (--psl_fft_users > 0) {
+        return;
+    }
+    while (psl_fft_plans) {
+        t_psl_fft_plan *p = psl_fft_plans;
+        psl_fft_plans = p->next;
+        gsl_fft_real_wavetable_free(p->real);
+        gsl_fft_halfcomplex_wavetable_free(p->hc);
+        gsl_fft_real_workspace_free(p->work);
+        freebytes(p->buf, p->n * sizeof(double));
+        freebytes(p, sizeof(*p));
+    }
+}
+
+
+// psl~ lookup tables: unary functions sampled over a domain and shared
+// between all psl~ objects using the same function, size and domain
+// ---------------------------------------------------------------------------
+
+
+typedef struct _psl_table {
+    t_psl_func *func;
+    int size;                // # of sample points over [lo, hi]
+    t_float lo;
+    t_float hi;
+    t_float scale;           // (size - 1) / (hi - lo)
+    t_sample *data;          // size + 2 points: 1 guard on either side
+    int refcount;
+    struct _psl_table *next;
+} t_psl_table;
+
+
+static t_psl_table *psl_tables = NULL;
+
+
+// interpolated read, `cubic` uses the same 4-point formula as tabread4~
+static inline t_sample psl_table_read(t_psl_table *t, t_sample in, int cubic) {
+    t_sample pos = (in - t->lo) * t->scale;
+
+    // NaN, e.g. from an upstream domain error, takes the lower clamp
+    if (!(pos >= 0)) pos = 0;
+    if (pos > t->size - 1) pos = t->size - 1;
+
+    int i = (int)pos;
+    if (i > t->size - 2) i = t->size - 2;
+    t_sample frac = pos - i;
+    t_sample *p = t->data + i;
+
+    if (!cubic) {
+        return p[1] + frac * (p[2] - p[1]);
+    }
+
+    t_sample a = p[0], b = p[1], c = p[2], d = p[3];
+    t_sample cminusb = c - b;
+    return b + frac * (cminusb - 0.1666667f * (1.f - frac) *
+        ((d - a - 3.0f * cminusb) * frac + (d + 2.0f * a - 3.0f * b)));
+}
+
+
+static t_psl_table *psl_table_build(t_psl_func *f, int size, t_float lo, t_float hi) {
+    t_psl_table *t = (t_psl_table *)getbytes(sizeof(*t));
+    t_sample *xs = (t_sample *)getbytes((size - 1) * sizeof(*xs));
+    t_sample *ys = (t_sample *)getbytes((size - 1) * sizeof(*ys));
+    t_float dx = (hi - lo) / (size - 1);
+
+    t->func = f;
+    t->size = size;
+    t->lo = lo;
+    t->hi = hi;
+    t->scale = (size - 1) / (hi - lo);
+    t->data = (t_sample *)getbytes((size + 2) * sizeof(*t->data));
+    t->refcount = 0;
+
+    // domain errors while sampling give NaN, see psl_gsl_error
+    t_sample *points = t->data + 1;
+    for (int i = 0; i < size; i++) {
+        points[i] = lo + i * dx;
+    }
+    f->kernel(size, &points, points);
+
+    // guard points by quadratic extrapolation, keeps the cubic read
+    // accurate up to the domain edges without leaving the domain
+    t_sample *d = t->data;
+    d[0] = 3 * d[1] - 3 * d[2] + d[3];
+    d[size + 1] = 3 * d[size] - 3 * d[size - 1] + d[size - 2];
+
+    // worst case error is halfway between sample points
+    for (int i = 0; i < size - 1; i++) {
+        xs[i] = lo + (i + 0.5) * dx;
+    }
+    f->kernel(size - 1, &xs, ys);
+
+    double err_lin = 0, err_cub = 0;
+    for (int i = 0; i < size - 1; i++) {
+        double e1 = fabs(psl_table_read(t, xs[i], 0) - ys[i]);
+        double e3 = fabs(psl_table_read(t, xs[i], 1) - ys[i]);
+        if (e1 > err_lin) err_lin = e1;
+        if (e3 > err_cub) err_cub = e3;
+    }
+    post("psl~ %s: %d-point table over [%g, %g], max error %g (linear) %g (cubic)",
+        f->name, size, lo, hi, err_lin, err_cub);
+
+    freebytes(xs, (size - 1) * sizeof(*xs));
+    freebytes(ys, (size - 1) * sizeof(*ys));
+
+    t->next = psl_tables;
+    psl_tables = t;
+    return t;
+}
+
+
+static t_psl_table *psl_table_acquire(t_psl_func *f, int size, t_float lo, t_float hi) {
+    t_psl_table *t;
+
+    for (t = psl_tables; t; t = t->next) {
+        if (t->func == f && t->size == size && t->lo == lo && t->hi == hi) {
+            break;
+        }
+    }
+    if (!t) {
+        t = psl_table_build(f, size, lo, hi);
+    }
+    t->refcount++;
+    return t;
+}
+
+
+static void psl_table_release(t_psl_table *t) {
+    if (--t->refcount > 0) {
+        return;
+    }
+
+    t_psl_table **p = &psl_tables;
+    while (*p != t) {
+        p = &(*p)->next;
+    }
+    *p = t->next;
+
+    freebytes(t->data, (t->size + 2) * sizeof(*t->data));
+    freebytes(t, sizeof(*t));
+}
+
+
+// psl~ class: signal-rate version of the function objects
+// ---------------------------------------------------------------------------
+
+
+// [psl~ conv <array>]: uniformly partitioned convolution, one partition per
+// dsp block of n. The impulse response is cut into k partitions whose 2n
+// point spectra are made once (at dsp or [set(); every block then costs one
+// forward and one inverse transform plus k spectral multiply-adds against
+// the spectra of the last k input blocks (the frequency delay line).
+typedef struct _psl_conv {
+    t_symbol *ir;           // array holding the impulse response
+    t_psl_fft_plan *plan;   // for 2n points
+    double *h;              // k partition spectra, halfcomplex
+    double *fdl;            // k input spectra, a ring ending at pos
+    double *acc;            // 2n, sum of the products
+    double *tail;           // n, second half of the previous block
+    int k;
+    int pos;
+    int n;                  // block size the spectra were made for
+} t_psl_conv;
+
+
+typedef struct _psl_tilde {
+    t_object x_obj;
+    t_float x_f;         // scalar for the main signal inlet
+
+    t_psl_func *func;
+    int nargs;
+
+    // table mode
+    t_psl_table *table;  // NULL when evaluating the function directly
+    int cubic;           // cubic instead of linear interpolation
+
+    // chebyshev mode
+    gsl_cheb_series *cheb;
+    t_sample *cheb_y;    // per-block scratch for the clenshaw recurrence
+    t_sample *cheb_d;
+    t_sample *cheb_dd;
+    int cheb_n;          // size of the scratch vectors
+
+    // expression mode: evaluated a block at a time, each variable reading
+    // its own double buffer (or expr_slot until the first dsp call)
+    te_program *expr;
+    double expr_slot[MAX_ARGS];
+    double *expr_in[MAX_ARGS];
+    double *expr_out;
+    double *expr_work;
+    int expr_n;          // block size the buffers were made for
+    int expr_work_n;     // size of expr_work
+
+    t_psl_conv *conv;    // NULL unless [psl~ conv ...]
+
+    t_psl_errors errors; // gsl errors in the perform routine
+
+    t_outlet *out_s;
+} t_psl_tilde;
+
+
+// w: [perform, x, n, in_0 .. in_nargs-1, out]
+static t_int *psl_tilde_perform(t_int *w) {
+    t_psl_tilde *x = (t_psl_tilde *)(w[1]);
+    int n = (int)(w[2]);
+
+    PSL_COUNTING(x, x->func->kernel(n, (t_sample **)(w + 3), (t_sample *)(w[3 + x->nargs])));
+
+    return (w + x->nargs + 4);
+}
+
+
+static t_int *psl_tilde_table_perform(t_int *w) {
+    t_psl_tilde *x = (t_psl_tilde *)(w[1]);
+    int n = (int)(w[2]);
+    t_sample *in = (t_sample *)(w[3]);
+    t_sample *out = (t_sample *)(w[4]);
+    t_psl_table *t = x->table;
+
+    if (x->cubic) {
+        for (int i = 0; i < n; i++) {
+            out[i] = psl_table_read(t, in[i], 1);
+        }
+    } else {
+        for (int i = 0; i < n; i++) {
+            out[i] = psl_table_read(t, in[i], 0);
+        }
+    }
+
+    return (w + 5);
+}
+
+
+// clenshaw recurrence run for the whole block per coefficient, so the inner
+// loops are independent across samples and vectorize
+static t_int *psl_tilde_cheb_perform(t_int *w) {
+    t_psl_tilde *x = (t_psl_tilde *)(w[1]);
+    int n = (int)(w[2]);
+    t_sample *in = (t_sample *)(w[3]);
+    t_sample *out = (t_sample *)(w[4]);
+    t_sample *y = x->cheb_y, *d = x->cheb_d, *dd = x->cheb_dd;
+    const double *c = gsl_cheb_coeffs(x->cheb);
+    int order = gsl_cheb_order(x->cheb);
+    t_sample lo = x->cheb->a, hi = x->cheb->b;
+    t_sample scale = 2 / (hi - lo), offset = -(hi + lo) / (hi - lo);
+
+    for (int i = 0; i < n; i++) {
+        t_sample v = in[i] < lo ? lo : (in[i] > hi ? hi : in[i]);
+        y[i] = 2 * (v * scale + offset);
+        d[i] = 0;
+        dd[i] = 0;
+    }
+
+    for (int j = order; j >= 1; j--) {
+        t_sample cj = c[j];
+        for (int i = 0; i < n; i++) {
+            t_sample tmp = d[i];
+            d[i] = y[i] * d[i] - dd[i] + cj;
+            dd[i] = tmp;
+        }
+    }
+
+    t_sample c0 = 0.5 * c[0];
+    for (int i = 0; i < n; i++) {
+        out[i] = 0.5f * y[i] * d[i] - dd[i] + c0;
+    }
+
+    return (w + 5);
+}
+
+
+// w: [perform, x, n, in_0 .. in_nargs-1, out]
+static t_int *psl_tilde_expr_perform(t_int *w) {
+    t_psl_tilde *x = (t_psl_tilde *)(w[1]);
+    int n = (int)(w[2]);
+    t_sample *out = (t_sample *)(w[3 + x->nargs]);
+
+    for (int j = 0; j < x->nargs; j++) {
+        t_sample *in = (t_sample *)(w[3 + j]);
+        double *v = x->expr_in[j];
+        for (int i = 0; i < n; i++) {
+            v[i] = in[i];
+        }
+    }
+
+    PSL_COUNTING(x, te_eval_program_block(x->expr, n, x->expr_out, x->expr_work));
+
+    for (int i = 0; i < n; i++) {
+        out[i] = x->expr_out[i];
+    }
+
+    return (w + x->nargs + 4);
+}
+
+
+// size the expression buffers for blocks of n and point the program at them
+static void psl_tilde_expr_resize(t_psl_tilde *x, int n) {
+    size_t old = x->expr_n * sizeof(double), new = n * sizeof(double);
+
+    for (int i = 0; i < x->nargs; i++) {
+        const double *from = x->expr_in[i] ? x->expr_in[i] : &x->expr_slot[i];
+        x->expr_in[i] = (double *)resizebytes(x->expr_in[i], old, new);
+        te_program_rebind(x->expr, from, x->expr_in[i]);
+    }
+    x->expr_out = (double *)resizebytes(x->expr_out, old, new);
+
+    int work = te_program_workspace(x->expr, n);
+    x->expr_work = (double *)resizebytes(x->expr_work,
+        x->expr_work_n * sizeof(double), work * sizeof(double));
+    x->expr_work_n = work;
+    x->expr_n = n;
+}
+
+
+// free the spectra and buffers, keeping the array name
+static void psl_conv_clear(t_psl_conv *c) {
+    int m = 2 * c->n;
+    freebytes(c->h, c->k * m * sizeof(double));
+    freebytes(c->fdl, c->k * m * sizeof(double));
+    freebytes(c->acc, m * sizeof(double));
+    freebytes(c->tail, c->n * sizeof(double));
+    c->h = c->fdl = c->acc = c->tail = NULL;
+    c->k = c->pos = c->n = 0;
+}
+
+
+// cut the impulse response into partitions of n and transform them
+static void psl_conv_prepare(t_psl_tilde *x, int n) {
+    t_psl_conv *c = x->conv;
+    t_garray *ga;
+    int size;
+
+    psl_conv_clear(c);
+    t_word *vec = psl_getarray(x, c->ir, &size, &ga);
+    if (!vec || size < 1) {
+        return;
+    }
+
+    int m = 2 * n;
+    c->n = n;
+    c->k = (size + n - 1) / n;
+    c->plan = psl_fft_plan(m);
+    c->h = (double *)getbytes(c->k * m * sizeof(double));
+    c->fdl = (double *)getbytes(c->k * m * sizeof(double));
+    c->acc = (double *)getbytes(m * sizeof(double));
+    c->tail = (double *)getbytes(n * sizeof(double));
+
+    for (int j = 0; j < c->k; j++) {
+        double *h = c->h + j * m;
+        for (int i = 0; i < n && j * n + i < size; i++) {
+            h[i] = vec[j * n + i].w_float;
+        }
+        PSL_COUNTING(x, gsl_fft_real_transform(h, 1, m, c->plan->real, c->plan->work));
+    }
+}
+
+
+// acc += a * b for halfcomplex spectra of m (even) points
+static inline void psl_conv_mac(double *acc, const double *a, const double *b, int m) {
+    acc[0] += a[0] * b[0];
+    for (int i = 1; i < m - 1; i += 2) {
+        double re = a[i] * b[i] - a[i + 1] * b[i + 1];
+        double im = a[i] * b[i + 1] + a[i + 1] * b[i];
+        acc[i] += re;
+        acc[i + 1] += im;
+    }
+    acc[m - 1] += a[m - 1] * b[m - 1];
+}
+
+
+// w: [perform, x, n, in, out]
+static t_int *psl_tilde_conv_perform(t_int *w) {
+    t_psl_tilde *x = (t_psl_tilde *)(w[1]);
+    int n = (int)(w[2]);
+    t_sample *in = (t_sample *)(w[3]);
+    t_sample *out = (t_sample *)(w[4]);
+    t_psl_conv *c = x->conv;
+    int m = 2 * n;
+
+    if (!c->k) {
+        for (int i = 0; i < n; i++) {
+            out[i] = 0;
+        }
+        return (w + 5);
+    }
+
+    // the newest block, zero padded, into the delay line
+    c->pos = (c->pos + 1) % c->k;
+    double *xs = c->fdl + c->pos * m;
+    for (int i = 0; i < n; i++) {
+        xs[i] = in[i];
+        xs[n + i] = 0;
+    }
+
+    PSL_COUNTING(x, gsl_fft_real_transform(xs, 1, m, c->plan->real, c->plan->work));
+
+    // partition j meets the input from j blocks ago
+    memset(c->acc, 0, m * sizeof(double));
+    for (int j = 0, p = c->pos; j < c->k; j++, p = p ? p - 1 : c->k - 1) {
+        psl_conv_mac(c->acc, c->fdl + p * m, c->h + j * m, m);
+    }
+
+    PSL_COUNTING(x, gsl_fft_halfcomplex_inverse(c->acc, 1, m, c->plan->hc, c->plan->work));
+
+    // overlap-add
+    for (int i = 0; i < n; i++) {
+        out[i] = c->acc[i] + c->tail[i];
+        c->tail[i] = c->acc[n + i];
+    }
+
+    return (w + 5);
+}
+
+
+// [set <array>(: another impulse response for [psl~ conv]
+static void psl_tilde_set(t_psl_tilde *x, t_symbol *s) {
+    if (!x->conv) {
+        pd_error(x, "psl~: set: only for psl~ conv");
+        return;
+    }
+    x->conv->ir = s;
+    if (x->conv->n) {
+        psl_conv_prepare(x, x->conv->n);
+    }
+}
+
+
+static void psl_tilde_errors(t_psl_tilde *x) {
+    psl_errors_report("psl~", x->func ? x->func->name : (x->conv ? "conv" : "expr"),
+        &x->errors);
+}
+
+
+static void psl_tilde_dsp(t_psl_tilde *x, t_signal **sp) {
+    t_int vec[MAX_ARGS + 3];
+    int n = sp[0]->s_n;
+
+    if (x->conv) {
+        if (n != x->conv->n) {
+            psl_conv_prepare(x, n);
+        }
+        dsp_add(psl_tilde_conv_perform, 4, x, n, sp[0]->s_vec, sp[1]->s_vec);
+        return;
+    }
+
+    if (x->expr) {
+        if (n != x->expr_n) {
+            psl_tilde_expr_resize(x, n);
+        }
+        vec[0] = (t_int)x;
+        vec[1] = (t_int)n;
+        for (int i = 0; i <= x->nargs; i++) {
+            vec[i + 2] = (t_int)sp[i]->s_vec;
+        }
+        dsp_addv(psl_tilde_expr_perform, x->nargs + 3, vec);
+        return;
+    }
+
+    if (x->table) {
+        dsp_add(psl_tilde_table_perform, 4, x, n, sp[0]->s_vec, sp[1]->s_vec);
+        return;
+    }
+
+    if (x->cheb) {
+        if (n != x->cheb_n) {
+            size_t old = x->cheb_n * sizeof(t_sample), new = n * sizeof(t_sample);
+            x->cheb_y = (t_sample *)resizebytes(x->cheb_y, old, new);
+            x->cheb_d = (t_sample *)resizebytes(x->cheb_d, old, new);
+            x->cheb_dd = (t_sample *)resizebytes(x->cheb_dd, old, new);
+            x->cheb_n = n;
+        }
+        dsp_add(psl_tilde_cheb_perform, 4, x, n, sp[0]->s_vec, sp[1]->s_vec);
+        return;
+    }
+
+    vec[0] = (t_int)x;
+    vec[1] = (t_int)sp[0]->s_n;
+    for (int i = 0; i <= x->nargs; i++) {
+        vec[i + 2] = (t_int)sp[i]->s_vec;
+    }
+    dsp_addv(psl_tilde_perform, x->nargs + 3, vec);
+}
+
+
+// [psl~ expr <expression>]: one signal inlet per variable a..f used
+static void *psl_tilde_expr_new(int argc, t_atom *argv) {
+    t_psl_tilde *x = (t_psl_tilde *)pd_new(psl_tilde_class);
+    char buf[MAXPDSTRING];
+
+    x->x_f = 0;
+    x->func = NULL;
+    psl_errors_init(&x->errors);
+    x->conv = NULL;
+    x->table = NULL;
+    x->cheb = NULL;
+    x->expr = NULL;
+    x->expr_out = x->expr_work = NULL;
+    x->expr_n = x->expr_work_n = 0;
+    x->nargs = 0;
+    for (int i = 0; i < MAX_ARGS; i++) {
+        x->expr_slot[i] = 0;
+        x->expr_in[i] = NULL;
+    }
+
+    te_expr *expr = psl_expr_parse(x, "psl~", buf, argc, argv, x->expr_slot);
+    if (!expr) {
+        pd_free((t_pd *)x);
+        return NULL;
+    }
+
+    int max = psl_expr_maxarg(x->expr_slot, expr);
+    if (!(x->expr = psl_expr_lower(x, expr))) {
+        pd_free((t_pd *)x);
+        return NULL;
+    }
+    x->nargs = max < 0 ? 1 : max + 1;
+
+    for (int i = 1; i < x->nargs; i++) {
+        inlet_new(&x->x_obj, &x->x_obj.ob_pd, &s_signal, &s_signal);
+    }
+
+    x->out_s = outlet_new(&x->x_obj, &s_signal);
+
+    return (void *)x;
+}
+
+
+// [psl~ <func> [-table <size> <lo> <hi>] [-cubic] | [-cheb <lo> <hi> <order>]]
+// [psl~ expr <expression>]
+// [psl~ conv <array>]: the spectra are made at the first dsp call
+static void *psl_tilde_conv_new(t_symbol *ir) {
+    if (ir == &s_) {
+        pd_error(0, "psl~ conv: needs an array name");
+        return NULL;
+    }
+
+    t_psl_tilde *x = (t_psl_tilde *)pd_new(psl_tilde_class);
+
+    x->x_f = 0;
+    x->func = NULL;
+    x->nargs = 1;
+    x->table = NULL;
+    x->cheb = NULL;
+    x->expr = NULL;
+    psl_errors_init(&x->errors);
+
+    x->conv = (t_psl_conv *)getbytes(sizeof(*x->conv));
+    x->conv->ir = ir;
+    x->conv->plan = NULL;
+    x->conv->h = x->conv->fdl = x->conv->acc = x->conv->tail = NULL;
+    x->conv->k = x->conv->pos = x->conv->n = 0;
+    psl_fft_users++;
+
+    x->out_s = outlet_new(&x->x_obj, &s_signal);
+
+    return (void *)x;
+}
+
+
+void *psl_tilde_new(t_symbol *s, int argc, t_atom *argv) {
+    t_symbol *name = atom_getsymbolarg(0, argc, argv);
+    t_psl_func *f = psl_lookup(name);
+    int size = 0, cubic = 0, order = 0;
+    t_float lo = 0, hi = 0;
+
+    if (name == gensym("expr")) {
+        return psl_tilde_expr_new(argc - 1, argv + 1);
+    }
+    if (name == gensym("conv")) {
+        return psl_tilde_conv_new(atom_getsymbolarg(1, argc, argv));
+    }
+
+    if (!f || !f->kernel) {
+        pd_error(0, "psl~: no signal function named '%s'", name->s_name);
+        return NULL;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        t_symbol *flag = atom_getsymbolarg(i, argc, argv);
+        if (flag == gensym("-table") && i + 3 < argc) {
+            size = (int)atom_getfloatarg(i + 1, argc, argv);
+            lo = atom_getfloatarg(i + 2, argc, argv);
+            hi = atom_getfloatarg(i + 3, argc, argv);
+            i += 3;
+        } else if (flag == gensym("-cubic")) {
+            cubic = 1;
+        } else if (flag == gensym("-cheb") && i + 3 < argc) {
+            lo = atom_getfloatarg(i + 1, argc, argv);
+            hi = atom_getfloatarg(i + 2, argc, argv);
+            order = (int)atom_getfloatarg(i + 3, argc, argv);
+            i += 3;
+        } else {
+            pd_error(0, "psl~ %s: bad argument at position %d", f->name, i);
+            return NULL;
+        }
+    }
+
+    if (size && (f->nargs != 1 || size < 4 || !(hi > lo))) {
+        pd_error(0, "psl~ %s: -table needs a unary function, size >= 4 and lo < hi",
+            f->name);
+        return NULL;
+    }
+
+    if (size && order) {
+        pd_error(0, "psl~ %s: -table and -cheb are exclusive", f->name);
+        return NULL;
+    }
+
+    gsl_cheb_series *cheb = NULL;
+    if (order && !(cheb = psl_cheb_build("psl~", f, lo, hi, order))) {
+        return NULL;
+    }
+
+    t_psl_tilde *x = (t_psl_tilde *)pd_new(psl_tilde_class);
+
+    x->x_f = 0;
+    x->func = f;
+    psl_errors_init(&x->errors);
+    x->conv = NULL;
+    x->nargs = f->nargs;
+    x->table = size ? psl_table_acquire(f, size, lo, hi) : NULL;
+    x->cubic = cubic;
+    x->cheb = cheb;
+    x->cheb_y = x->cheb_d = x->cheb_dd = NULL;
+    x->cheb_n = 0;
+    x->expr = NULL;
+
+    // every extra argument gets a signal inlet which also accepts floats
+    for (int i = 1; i < x->nargs; i++) {
+        inlet_new(&x->x_obj, &x->x_obj.ob_pd, &s_signal, &s_signal);
+    }
+
+    x->out_s = outlet_new(&x->x_obj, &s_signal);
+
+    return (void *)x;
+}
+
+
+void psl_tilde_free(t_psl_tilde *x) {
+    if (x->table) {
+        psl_table_release(x->table);
+    }
+    if (x->cheb) {
+        gsl_cheb_free(x->cheb);
+        freebytes(x->cheb_y, x->cheb_n * sizeof(t_sample));
+        freebytes(x->cheb_d, x->cheb_n * sizeof(t_sample));
+        freebytes(x->cheb_dd, x->cheb_n * sizeof(t_sample));
+    }
+    if (x->expr) {
+        te_free_program(x->expr);
+        for (int i = 0; i < x->nargs; i++) {
+            freebytes(x->expr_in[i], x->expr_n * sizeof(double));
+        }
+        freebytes(x->expr_out, x->expr_n * sizeof(double));
+        freebytes(x->expr_work, x->expr_work_n * sizeof(double));
+    }
+    if (x->conv) {
+        psl_conv_clear(x->conv);
+        freebytes(x->conv, sizeof(*x->conv));
+        psl_fft_release();
+    }
+}
+
+
+// psl.fft class: GSL's mixed-radix FFT on pd arrays, for any size
+// ---------------------------------------------------------------------------
+
+
+typedef struct _psl_fft {
+    t_object x_obj;
+    t_psl_errors errors;
+    t_outlet *out_b;        // bang once a transform is written
+} t_psl_fft;
+
+
+// copy the array into the plan's buffer and transform it there
+static t_psl_fft_plan *psl_fft_run(t_psl_fft *x, const char *sel, t_word *vec,
+                                   int n, int inverse) {
+    if (n < 2) {
+        pd_error(x, "psl.fft: %s: array needs at least 2 points", sel);
+        return NULL;
+    }
+
+    t_psl_fft_plan *p = psl_fft_plan(n);
+    for (int i = 0; i < n; i++) {
+        p->buf[i] = vec[i].w_float;
+    }
+
+    int status;
+    if (inverse) {
+        PSL_COUNTING(x, status = gsl_fft_halfcomplex_inverse(p->buf, 1, n, p->hc, p->work));
+    } else {
+        PSL_COUNTING(x, status = gsl_fft_real_transform(p->buf, 1, n, p->real, p->work));
+    }
+    if (status) {
+        pd_error(x, "psl.fft: %s: %s", sel, gsl_strerror(status));
+        return NULL;
+    }
+    return p;
+}
+
+
+// [real <array>(: forward transform in place, in GSL's halfcomplex order
+// r0 r1 i1 r2 i2 ... (with r(n/2) last for even n)
+static void psl_fft_real(t_psl_fft *x, t_symbol *s) {
+    t_garray *ga;
+    int n;
+    t_word *vec = psl_getarray(x, s, &n, &ga);
+    t_psl_fft_plan *p;
+
+    if (!vec || !(p = psl_fft_run(x, "real", vec, n, 0))) {
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        vec[i].w_float = p->buf[i];
+    }
+    garray_redraw(ga);
+    outlet_bang(x->out_b);
+}
+
+
+// [inverse <array>(: halfcomplex back to real in place, scaled by 1/n
+static void psl_fft_inverse(t_psl_fft *x, t_symbol *s) {
+    t_garray *ga;
+    int n;
+    t_word *vec = psl_getarray(x, s, &n, &ga);
+    t_psl_fft_plan *p;
+
+    if (!vec || !(p = psl_fft_run(x, "inverse", vec, n, 1))) {
+        return;
+    }
+    for (int i = 0; i < n; i++) {
+        vec[i].w_float = p->buf[i];
+    }
+    garray_redraw(ga);
+    outlet_bang(x->out_b);
+}
+
+
+// [polar <src> <mag> [<phase>](: magnitude and phase of the n/2 + 1 bins of
+// src, which is left as it is; the outputs are written up to their size
+static void psl_fft_polar(t_psl_fft *x, t_symbol *src, t_symbol *mag, t_symbol *phase) {
+    t_garray *ga, *mag_ga, *ph_ga = NULL;
+    int n, n_mag, n_ph = 0;
+    t_word *vec, *vmag, *vph = NULL;
+    t_psl_fft_plan *p;
+
+    if (!(vec = psl_getarray(x, src, &n, &ga))
+        || !(vmag = psl_getarray(x, mag, &n_mag, &mag_ga))
+        || (phase != &s_ && !(vph = psl_getarray(x, phase, &n_ph, &ph_ga)))) {
+        return;
+    }
+    if (!(p = psl_fft_run(x, "polar", vec, n, 0))) {
+        return;
+    }
+
+    int bins = n / 2 + 1;
+    for (int k = 0; k < bins; k++) {
+        double re = k == 0 ? p->buf[0] : p->buf[2 * k - 1];
+        double im = (k == 0 || 2 * k == n) ? 0 : p->buf[2 * k];
+        if (k < n_mag) {
+            vmag[k].w_float = hypot(re, im);
+        }
+        if (k < n_ph) {
+            vph[k].w_float = atan2(im, re);
+        }
+    }
+    garray_redraw(mag_ga);
+    if (ph_ga) {
+        garray_redraw(ph_ga);
+    }
+    outlet_bang(x->out_b);
+}
+
+
+static void psl_fft_errors(t_psl_fft *x) {
+    psl_errors_report("psl.fft", "-", &x->errors);
+}
+
+
+// [psl.fft]
+static void *psl_fft_new(void) {
+    t_psl_fft *x = (t_psl_fft *)pd_new(psl_fft_class);
+    psl_errors_init(&x->errors);
+    x->out_b = outlet_new(&x->x_obj, &s_bang);
+    psl_fft_users++;
+    return (void *)x;
+}
+
+
+static void psl_fft_free(t_psl_fft *x) {
+    psl_fft_release();
+}
+
+
+// psl.wavelet class: discrete wavelet transforms of pd arrays
+// ---------------------------------------------------------------------------
+
+
+// wavelet and workspace for one (family, k, n), shared like the FFT plans;
+// buf is the double copy of the array, n or n * n values for 2d
+typedef struct _psl_wavelet_plan {
+    const gsl_wavelet_type *type;
+    size_t k;
+    size_t n;
+    gsl_wavelet *wavelet;
+    gsl_wavelet_workspace *work;
+    double *buf;
+    size_t buf_n;
+    struct _psl_wavelet_plan *next;
+} t_psl_wavelet_plan;
+
+
+static t_psl_wavelet_plan *psl_wavelet_plans;
+static int psl_wavelet_users;
+
+
+typedef struct _psl_wavelet {
+    t_object x_obj;
+    const gsl_wavelet_type *type;
+    int k;
+    t_psl_errors errors;
+    t_outlet *out_b;        // bang once a transform is written
+} t_psl_wavelet;
+
+
+static const gsl_wavelet_type *psl_wavelet_type(t_symbol *s) {
+    if (s == gensym("daubechies")) return gsl_wavelet_daubechies;
+    if (s == gensym("daubechies_centered")) return gsl_wavelet_daubechies_centered;
+    if (s == gensym("haar")) return gsl_wavelet_haar;
+    if (s == gensym("haar_centered")) return gsl_wavelet_haar_centered;
+    if (s == gensym("bspline")) return gsl_wavelet_bspline;
+    if (s == gensym("bspline_centered")) return gsl_wavelet_bspline_centered;
+    return NULL;
+}
+
+
+// the plan for x's wavelet and n points, with a buffer of at least len
+static t_psl_wavelet_plan *psl_wavelet_plan(t_psl_wavelet *x, size_t n, size_t len) {
+    t_psl_wavelet_plan *p;
+
+    for (p = psl_wavelet_plans; p; p = p->next) {
+        if (p->type == x->type && p->k == (size_t)x->k && p->n == n) {
+            break;
+        }
+    }
+    if (!p) {
+        gsl_wavelet *w;
+        PSL_COUNTING(x, w = gsl_wavelet_alloc(x->type, x->k));
+        if (!w) {
+            return NULL;
+        }
+        p = (t_psl_wavelet_plan *)getbytes(sizeof(*p));
+        p->type = x->type;
+        p->k = x->k;
+        p->n = n;
+        p->wavelet = w;
+        p->work = gsl_wavelet_workspace_alloc(n);
+        p->buf = NULL;
+        p->buf_n = 0;
+        p->next = psl_wavelet_plans;
+        psl_wavelet_plans = p;
+    }
+    if (p->buf_n < len) {
+        p->buf = (double *)resizebytes(p->buf, p->buf_n * sizeof(double), len * sizeof(double));
+        p->buf_n = len;
+    }
+    return p;
+}
+
+
+static void psl_wavelet_release(void) {
+    if (--psl_wavelet_users > 0) {
+        return;
+    }
+    while (psl_wavelet_plans) {
+        t_psl_wavelet_plan *p = psl_wavelet_plans;
+        psl_wavelet_plans = p->next;
+        gsl_wavelet_free(p->wavelet);
+        gsl_wavelet_workspace_free(p->work);
+        freebytes(p->buf, p->buf_n * sizeof(double));
+        freebytes(p, sizeof(*p));
+    }
+}
+
+
+typedef enum {
+    PSL_WAVELET_FORWARD,
+    PSL_WAVELET_INVERSE,
+    PSL_WAVELET_FORWARD2D,
+    PSL_WAVELET_INVERSE2D,
+    PSL_WAVELET_DENOISE,
+} t_psl_wavelet_op;
+
+
+// zero the detail coefficients below t, or shrink all of them by t (soft)
+static void psl_wavelet_threshold(double *c, int n, double t, int soft) {
+    for (int i = 1; i < n; i++) {
+        double a = fabs(c[i]);
+        if (a < t) {
+            c[i] = 0;
+        } else if (soft) {
+            c[i] = c[i] > 0 ? a - t : t - a;
+        }
+    }
+}
+
+
+// copy the array in, transform, copy back; 2d takes a square array of side
+// sqrt(size), and every size has to be a power of two
+static void psl_wavelet_run(t_psl_wavelet *x, const char *sel, t_symbol *s,
+                            t_psl_wavelet_op op, double t, int soft) {
+    t_garray *ga;
+    int len;
+    t_word *vec = psl_getarray(x, s, &len, &ga);
+    if (!vec) {
+        return;
+    }
+
+    int is2d = op == PSL_WAVELET_FORWARD2D || op == PSL_WAVELET_INVERSE2D;
+    int n = is2d ? (int)sqrt(len) : len;
+    if (n < 2 || (n & (n - 1)) || (is2d && n * n != len)) {
+        pd_error(x, is2d ? "psl.wavelet: %s: needs n * n points, n a power of two, not %d"
+                         : "psl.wavelet: %s: size must be a power of two, not %d", sel, len);
+        return;
+    }
+
+    t_psl_wavelet_plan *p = psl_wavelet_plan(x, n, len);
+    if (!p) {
+        pd_error(x, "psl.wavelet: no such wavelet member k = %d", x->k);
+        return;
+    }
+    for (int i = 0; i < len; i++) {
+        p->buf[i] = vec[i].w_float;
+    }
+
+    int status = 0;
+    switch (op) {
+    case PSL_WAVELET_FORWARD:
+        PSL_COUNTING(x, status = gsl_wavelet_transform_forward(p->wavelet, p->buf, 1, n, p->work));
+        break;
+    case PSL_WAVELET_INVERSE:
+        PSL_COUNTING(x, status = gsl_wavelet_transform_inverse(p->wavelet, p->buf, 1, n, p->work));
+        break;
+    case PSL_WAVELET_FORWARD2D:
+        PSL_COUNTING(x, status = gsl_wavelet2d_transform_forward(p->wavelet, p->buf, n, n, n, p->work));
+        break;
+    case PSL_WAVELET_INVERSE2D:
+        PSL_COUNTING(x, status = gsl_wavelet2d_transform_inverse(p->wavelet, p->buf, n, n, n, p->work));
+        break;
+    case PSL_WAVELET_DENOISE:
+        PSL_COUNTING(x, status = gsl_wavelet_transform_forward(p->wavelet, p->buf, 1, n, p->work));
+        if (!status) {
+            psl_wavelet_threshold(p->buf, n, t, soft);
+            PSL_COUNTING(x, status = gsl_wavelet_transform_inverse(p->wavelet, p->buf, 1, n, p->work));
+        }
+        break;
+    }
+    if (status) {
+        pd_error(x, "psl.wavelet: %s: %s", sel, gsl_strerror(status));
+        return;
+    }
+
+    for (int i = 0; i < len; i++) {
+        vec[i].w_float = p->buf[i];
+    }
+    garray_redraw(ga);
+    outlet_bang(x->out_b);
+}
+
+
+static void psl_wavelet_forward(t_psl_wavelet *x, t_symbol *s) {
+    psl_wavelet_run(x, "forward", s, PSL_WAVELET_FORWARD, 0, 0);
+}
+
+static void psl_wavelet_inverse(t_psl_wavelet *x, t_symbol *s) {
+    psl_wavelet_run(x, "inverse", s, PSL_WAVELET_INVERSE, 0, 0);
+}
+
+static void psl_wavelet_forward2d(t_psl_wavelet *x, t_symbol *s) {
+    psl_wavelet_run(x, "forward2d", s, PSL_WAVELET_FORWARD2D, 0, 0);
+}
+
+static void psl_wavelet_inverse2d(t_psl_wavelet *x, t_symbol *s) {
+    psl_wavelet_run(x, "inverse2d", s, PSL_WAVELET_INVERSE2D, 0, 0);
+}
+
+// [denoise <array> <threshold> [soft](: forward, threshold, inverse in place
+static void psl_wavelet_denoise(t_psl_wavelet *x, t_symbol *s, t_floatarg t, t_symbol *mode) {
+    psl_wavelet_run(x, "denoise", s, PSL_WAVELET_DENOISE, t, mode == gensym("soft"));
+}
+
+
+static void psl_wavelet_errors(t_psl_wavelet *x) {
+    psl_errors_report("psl.wavelet", "-", &x->errors);
+}
+
+
+// [psl.wavelet [<family> [<k>]]], daubechies 4 by default
+static void *psl_wavelet_new(t_symbol *s, int argc, t_atom *argv) {
+    t_symbol *family = argc > 0 ? atom_getsymbolarg(0, argc, argv) : gensym("daubechies");
+    int k = (int)atom_getfloatarg(1, argc, argv);
+    const gsl_wavelet_type *type = psl_wavelet_type(family);
+    if (!type) {
+        pd_error(0, "psl.wavelet: unknown family '%s'", family->s_name);
+        return NULL;
+    }
+
+    // the smallest member of each family
+    if (k <= 0) {
+        if (type == gsl_wavelet_haar || type == gsl_wavelet_haar_centered) {
+            k = 2;
+        } else if (type == gsl_wavelet_bspline || type == gsl_wavelet_bspline_centered) {
+            k = 103;
+        } else {
+            k = 4;
+        }
+    }
+
+    t_psl_wavelet *x = (t_psl_wavelet *)pd_new(psl_wavelet_class);
+    x->type = type;
+    x->k = k;
+    psl_errors_init(&x->errors);
+    psl_wavelet_users++;
+
+    // not every k is a member: check it once here rather than on each transform
+    gsl_wavelet *w;
+    PSL_COUNTING(x, w = gsl_wavelet_alloc(type, k));
+    if (!w) {
+        pd_error(0, "psl.wavelet: %s has no member %d", family->s_name, k);
+        pd_free((t_pd *)x);
+        return NULL;
+    }
+    gsl_wavelet_free(w);
+
+    x->out_b = outlet_new(&x->x_obj, &s_bang);
+    return (void *)x;
+}
+
+
+static void psl_wavelet_free(t_psl_wavelet *x) {
+    psl_wavelet_release();
+}
+
+
+// psl.rstat class: running statistics of a stream of floats
+// ---------------------------------------------------------------------------
+
+
+// every float updates gsl_rstat in constant time and memory; the median and
+// any further quantiles are P^2 estimates, also in constant memory
+#define PSL_RSTAT_N 9       // n mean variance sd skew kurtosis min max median
+
+typedef struct _psl_rstat {
+    t_object x_obj;
+    gsl_rstat_workspace *rstat;
+    gsl_rstat_quantile_workspace **quantiles;
+    int n_quantiles;
+    t_atom *av;             // PSL_RSTAT_N + n_quantiles
+    t_outlet *out;
+} t_psl_rstat;
+
+
+static void psl_rstat_float(t_psl_rstat *x, t_floatarg f) {
+    gsl_rstat_add(f, x->rstat);
+    for (int i = 0; i < x->n_quantiles; i++) {
+        gsl_rstat_quantile_add(f, x->quantiles[i]);
+    }
+}
+
+
+static void psl_rstat_list(t_psl_rstat *x, t_symbol *s, int argc, t_atom *argv) {
+    for (int i = 0; i < argc; i++) {
+        psl_rstat_float(x, atom_getfloat(argv + i));
+    }
+}
+
+
+// [bang(: n mean variance sd skew kurtosis min max median, then the
+// quantiles given at creation
+static void psl_rstat_bang(t_psl_rstat *x) {
+    gsl_rstat_workspace *w = x->rstat;
+    t_atom *av = x->av;
+
+    SETFLOAT(av + 0, gsl_rstat_n(w));
+    SETFLOAT(av + 1, gsl_rstat_mean(w));
+    SETFLOAT(av + 2, gsl_rstat_variance(w));
+    SETFLOAT(av + 3, gsl_rstat_sd(w));
+    SETFLOAT(av + 4, gsl_rstat_skew(w));
+    SETFLOAT(av + 5, gsl_rstat_kurtosis(w));
+    SETFLOAT(av + 6, gsl_rstat_min(w));
+    SETFLOAT(av + 7, gsl_rstat_max(w));
+    SETFLOAT(av + 8, gsl_rstat_median(w));
+    for (int i = 0; i < x->n_quantiles; i++) {
+        SETFLOAT(av + PSL_RSTAT_N + i, gsl_rstat_quantile_get(x->quantiles[i]));
+    }
+    outlet_list(x->out, &s_list, PSL_RSTAT_N + x->n_quantiles, av);
+}
+
+
+static void psl_rstat_reset(t_psl_rstat *x) {
+    gsl_rstat_reset(x->rstat);
+    for (int i = 0; i < x->n_quantiles; i++) {
+        gsl_rstat_quantile_reset(x->quantiles[i]);
+    }
+}
+
+
+// [psl.rstat [<p> ...]]: optional quantiles to estimate, 0 < p < 1
+static void *psl_rstat_new(t_symbol *s, int argc, t_atom *argv) {
+    for (int i = 0; i < argc; i++) {
+        t_float p = atom_getfloatarg(i, argc, argv);
+        if (!(p > 0 && p < 1)) {
+            pd_error(0, "psl.rstat: quantiles must lie between 0 and 1, not %g", p);
+            return NULL;
+        }
+    }
+
+    t_psl_rstat *x = (t_psl_rstat *)pd_new(psl_rstat_class);
+
+    x->rstat = gsl_rstat_alloc();
+    x->n_quantiles = argc;
+    x->quantiles = (gsl_rstat_quantile_workspace **)getbytes(argc * sizeof(*x->quantiles));
+    for (int i = 0; i < argc; i++) {
+        x->quantiles[i] = gsl_rstat_quantile_alloc(atom_getfloatarg(i, argc, argv));
+    }
+    x->av = (t_atom *)getbytes((PSL_RSTAT_N + argc) * sizeof(t_atom));
+    x->out = outlet_new(&x->x_obj, &s_list);
+
+    return (void *)x;
+}
+
+
+static void psl_rstat_free(t_psl_rstat *x) {
+    gsl_rstat_free(x->rstat);
+    for (int i = 0; i < x->n_quantiles; i++) {
+        gsl_rstat_quantile_free(x->quantiles[i]);
+    }
+    freebytes(x->quantiles, x->n_quantiles * sizeof(*x->quantiles));
+    freebytes(x->av, (PSL_RSTAT_N + x->n_quantiles) * sizeof(t_atom));
+}
+
+
+// psl.stft~ / psl.istft~ classes: streaming short-time fourier transform
+// ---------------------------------------------------------------------------
+
+
+// Frames of `size` samples every `hop` = size / overlap samples, windowed
+// and transformed with the shared FFT plans. A frame is n/2 + 1 magnitudes
+// and as many phases: psl.stft~ sends them out as two lists (phases first)
+// or writes them to arrays, psl.istft~ takes them the same way and
+// overlap-adds the windowed inverse. Every buffer is made at creation or in
+// the dsp method, so there is no allocation per frame. Frames are computed
+// in the perform routine and sent out by a clock right after it.
+
+typedef struct _psl_stft {
+    t_object x_obj;
+    t_float x_f;            // psl.stft~: scalar for the signal inlet
+
+    int size;
+    int hop;
+    int bins;               // size / 2 + 1
+    double *window;         // size
+    double gain;            // psl.istft~: 1 / overlap-added window power
+    t_psl_fft_plan *plan;
+    double *frame;          // size, the transform buffer
+
+    // psl.stft~: the last `size` input samples and frames not yet sent out,
+    // each of 2 * bins values (magnitudes, then phases)
+    double *hist;
+    int hist_pos;
+    int count;              // samples since the last frame
+    double *pending;
+    int pending_max;
+    int pending_n;
+    t_clock *clock;
+
+    // psl.istft~: the overlap-add ring, read at rd, with the next frame
+    // going `ahead` samples later
+    double *ola;
+    int ola_size;
+    int rd;
+    int ahead;
+    double *mag;            // bins, the frame being taken in
+    double *phase;          // bins, from the right inlet
+
+    t_symbol *mag_array;    // frames to/from arrays instead of lists
+    t_symbol *phase_array;
+    t_atom *av;             // bins, for list output
+
+    t_psl_errors errors;
+    t_outlet *out_mag;      // psl.stft~; psl.istft~ has only out_s
+    t_outlet *out_phase;
+    t_outlet *out_s;
+} t_psl_stft;
+
+
+// periodic windows, so that overlapping copies sum to a constant
+static int psl_stft_window(double *w, int n, t_symbol *type) {
+    for (int i = 0; i < n; i++) {
+        double c = 2 * M_PI * i / n;
+        if (type == gensym("hann")) {
+            w[i] = 0.5 - 0.5 * cos(c);
+        } else if (type == gensym("hamming")) {
+            w[i] = 0.54 - 0.46 * cos(c);
+        } else if (type == gensym("blackman")) {
+            w[i] = 0.42 - 0.5 * cos(c) + 0.08 * cos(2 * c);
+        } else if (type == gensym("rect")) {
+            w[i] = 1;
+        } else {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+
+// [psl.stft~ <size> [<overlap>] [<window>]], likewise psl.istft~
+static t_psl_stft *psl_stft_alloc(t_class *cls, int argc, t_atom *argv) {
+    const char *name = class_getname(cls);
+    int size = argc > 0 ? (int)atom_getfloatarg(0, argc, argv) : 1024;
+    int overlap = argc > 1 ? (int)atom_getfloatarg(1, argc, argv) : 4;
+    t_symbol *type = argc > 2 ? atom_getsymbolarg(2, argc, argv) : gensym("hann");
+
+    if (size < 2 || overlap < 1 || size / overlap < 1) {
+        pd_error(0, "%s: needs size >= 2 and 1 <= overlap <= size", name);
+        return NULL;
+    }
+
+    t_psl_stft *x = (t_psl_stft *)pd_new(cls);
+
+    x->x_f = 0;
+    x->size = size;
+    x->hop = size / overlap;
+    x->bins = size / 2 + 1;
+    x->window = (double *)getbytes(size * sizeof(double));
+    if (!psl_stft_window(x->window, size, type)) {
+        pd_error(x, "%s: unknown window '%s', using hann", name, type->s_name);
+        psl_stft_window(x->window, size, gensym("hann"));
+    }
+    double power = 0;
+    for (int i = 0; i < size; i++) {
+        power += x->window[i] * x->window[i];
+    }
+    x->gain = x->hop / power;
+    x->plan = psl_fft_plan(size);
+    psl_fft_users++;
+    x->frame = (double *)getbytes(size * sizeof(double));
+
+    x->hist = NULL;
+    x->hist_pos = x->count = 0;
+    x->pending = NULL;
+    x->pending_max = x->pending_n = 0;
+    x->clock = NULL;
+    x->ola = NULL;
+    x->ola_size = x->rd = x->ahead = 0;
+    x->mag = x->phase = NULL;
+    x->mag_array = x->phase_array = NULL;
+    x->av = (t_atom *)getbytes(x->bins * sizeof(t_atom));
+    psl_errors_init(&x->errors);
+    x->out_mag = x->out_phase = x->out_s = NULL;
+
+    return x;
+}
+
+
+static void psl_stft_free(t_psl_stft *x) {
+    freebytes(x->window, x->size * sizeof(double));
+    freebytes(x->frame, x->size * sizeof(double));
+    freebytes(x->hist, x->size * sizeof(double));
+    freebytes(x->pending, x->pending_max * 2 * x->bins * sizeof(double));
+    freebytes(x->ola, x->ola_size * sizeof(double));
+    freebytes(x->mag, x->bins * sizeof(double));
+    freebytes(x->phase, x->bins * sizeof(double));
+    freebytes(x->av, x->bins * sizeof(t_atom));
+    if (x->clock) {
+        clock_free(x->clock);
+    }
+    psl_fft_release();
+}
+
+
+// [arrays <mag> [<phase>](: frames to (psl.stft~) or from (psl.istft~) arrays,
+// [arrays( alone goes back to lists
+static void psl_stft_arrays(t_psl_stft *x, t_symbol *mag, t_symbol *phase) {
+    x->mag_array = mag != &s_ ? mag : NULL;
+    x->phase_array = phase != &s_ ? phase : NULL;
+}
+
+
+static void psl_stft_errors(t_psl_stft *x) {
+    psl_errors_report(class_getname(pd_class(&x->x_obj.ob_pd)), "-", &x->errors);
+}
+
+
+// write n values to the array s, up to its size
+static void psl_stft_write(t_psl_stft *x, t_symbol *s, const double *v, int n) {
+    t_garray *ga;
+    int size;
+    t_word *vec = psl_getarray(x, s, &size, &ga);
+    if (!vec) {
+        return;
+    }
+    for (int i = 0; i < n && i < size; i++) {
+        vec[i].w_float = v[i];
+    }
+    garray_redraw(ga);
+}
+
+
+static void psl_stft_tick(t_psl_stft *x) {
+    for (int f = 0; f < x->pending_n; f++) {
+        double *mag = x->pending + f * 2 * x->bins;
+        double *phase = mag + x->bins;
+
+        if (x->mag_array) {
+            if (x->phase_array) {
+                psl_stft_write(x, x->phase_array, phase, x->bins);
+            }
+            psl_stft_write(x, x->mag_array, mag, x->bins);
+            outlet_bang(x->out_mag);
+            continue;
+        }
+
+        for (int i = 0; i < x->bins; i++) {
+            SETFLOAT(x->av + i, phase[i]);
+        }
+        outlet_list(x->out_phase, &s_list, x->bins, x->av);
+        for (int i = 0; i < x->bins; i++) {
+            SETFLOAT(x->av + i, mag[i]);
+        }
+        outlet_list(x->out_mag, &s_list, x->bins, x->av);
+    }
+    x->pending_n = 0;
+}
+
+
+// the frame ending at the newest sample: window, transform, to polar
+static void psl_stft_frame(t_psl_stft *x) {
+    int n = x->size;
+    for (int i = 0; i < n; i++) {
+        x->frame[i] = x->window[i] * x->hist[(x->hist_pos + i) % n];
+    }
+    PSL_COUNTING(x, gsl_fft_real_transform(x->frame, 1, n, x->plan->real, x->plan->work));
+
+    // the clock has not run within this block: keep the latest frames
+    if (x->pending_n == x->pending_max) {
+        memmove(x->pending, x->pending + 2 * x->bins,
+            (x->pending_max - 1) * 2 * x->bins * sizeof(double));
+        x->pending_n--;
+    }
+    double *mag = x->pending + x->pending_n++ * 2 * x->bins;
+    double *phase = mag + x->bins;
+    for (int k = 0; k < x->bins; k++) {
+        double re = k == 0 ? x->frame[0] : x->frame[2 * k - 1];
+        double im = (k == 0 || 2 * k == n) ? 0 : x->frame[2 * k];
+        mag[k] = hypot(re, im);
+        phase[k] = atan2(im, re);
+    }
+}
+
+
+// w: [perform, x, n, in]
+static t_int *psl_stft_perform(t_int *w) {
+    t_psl_stft *x = (t_psl_stft *)(w[1]);
+    int n = (int)(w[2]);
+    t_sample *in = (t_sample *)(w[3]);
+    int before = x->pending_n;
+
+    for (int i = 0; i < n; i++) {
+        x->hist[x->hist_pos] = in[i];
+        x->hist_pos = (x->hist_pos + 1) % x->size;
+        if (++x->count == x->hop) {
+            x->count = 0;
+            psl_stft_frame(x);
+        }
+    }
+    if (x->pending_n != before) {
+        clock_delay(x->clock, 0);
+    }
+
+    return (w + 4);
+}
+
+
+static void psl_stft_dsp(t_psl_stft *x, t_signal **sp) {
+    int n = sp[0]->s_n;
+    int max = n / x->hop + 1;
+
+    if (max != x->pending_max) {
+        x->pending = (double *)resizebytes(x->pending,
+            x->pending_max * 2 * x->bins * sizeof(double),
+            max * 2 * x->bins * sizeof(double));
+        x->pending_max = max;
+        x->pending_n = 0;
+    }
+    dsp_add(psl_stft_perform, 3, x, n, sp[0]->s_vec);
+}
+
+
+static void *psl_stft_new(t_symbol *s, int argc, t_atom *argv) {
+    t_psl_stft *x = psl_stft_alloc(psl_stft_class, argc, argv);
+    if (!x) {
+        return NULL;
+    }
+
+    x->hist = (double *)getbytes(x->size * sizeof(double));
+    x->clock = clock_new(x, (t_method)psl_stft_tick);
+    x->out_mag = outlet_new(&x->x_obj, &s_list);
+    x->out_phase = outlet_new(&x->x_obj, &s_list);
+
+    return (void *)x;
+}
+
+
+// add the frame in x->mag and x->phase to the output
+static void psl_istft_add(t_psl_stft *x) {
+    int n = x->size;
+
+    if (!x->ola) {
+        return;
+    }
+    // frames arriving faster than the signal plays them are dropped
+    if (x->ahead + n > x->ola_size) {
+        return;
+    }
+
+    for (int k = 0; k < x->bins; k++) {
+        double re = x->mag[k] * cos(x->phase[k]);
+        double im = x->mag[k] * sin(x->phase[k]);
+        if (k == 0) {
+            x->frame[0] = re;
+        } else {
+            x->frame[2 * k - 1] = re;
+            if (2 * k < n) {
+                x->frame[2 * k] = im;
+            }
+        }
+    }
+    PSL_COUNTING(x, gsl_fft_halfcomplex_inverse(x->frame, 1, n, x->plan->hc, x->plan->work));
+
+    for (int i = 0, j = (x->rd + x->ahead) % x->ola_size; i < n; i++) {
+        x->ola[j] += x->gain * x->window[i] * x->frame[i];
+        j = j + 1 == x->ola_size ? 0 : j + 1;
+    }
+    x->ahead += x->hop;
+}
+
+
+static void psl_istft_read(int argc, t_atom *argv, double *v, int n) {
+    for (int k = 0; k < n; k++) {
+        v[k] = k < argc ? atom_getfloat(argv + k) : 0;
+    }
+}
+
+
+// a list of magnitudes, with the phases last sent to the right inlet
+static void psl_istft_list(t_psl_stft *x, t_symbol *s, int argc, t_atom *argv) {
+    psl_istft_read(argc, argv, x->mag, x->bins);
+    psl_istft_add(x);
+}
+
+
+static void psl_istft_phase(t_psl_stft *x, t_symbol *s, int argc, t_atom *argv) {
+    psl_istft_read(argc, argv, x->phase, x->bins);
+}
+
+
+// [bang(: a frame from the arrays given with [arrays(
+static void psl_istft_bang(t_psl_stft *x) {
+    t_garray *ga;
+    int size;
+    t_word *vec;
+
+    if (!x->mag_array) {
+        pd_error(x, "psl.istft~: no arrays to read, see [arrays(");
+        return;
+    }
+    if (!(vec = psl_getarray(x, x->mag_array, &size, &ga))) {
+        return;
+    }
+    for (int k = 0; k < x->bins; k++) {
+        x->mag[k] = k < size ? vec[k].w_float : 0;
+    }
+    if (x->phase_array) {
+        if (!(vec = psl_getarray(x, x->phase_array, &size, &ga))) {
+            return;
+        }
+        for (int k = 0; k < x->bins; k++) {
+            x->phase[k] = k < size ? vec[k].w_float : 0;
+        }
+    }
+    psl_istft_add(x);
+}
+
+
+// w: [perform, x, n, out]
+static t_int *psl_istft_perform(t_int *w) {
+    t_psl_stft *x = (t_psl_stft *)(w[1]);
+    int n = (int)(w[2]);
+    t_sample *out = (t_sample *)(w[3]);
+
+    for (int i = 0; i < n; i++) {
+        out[i] = x->ola[x->rd];
+        x->ola[x->rd] = 0;
+        x->rd = x->rd + 1 == x->ola_size ? 0 : x->rd + 1;
+    }
+    // frames arriving late start at the current block
+    x->ahead = x->ahead > n ? x->ahead - n : 0;
+
+    return (w + 4);
+}
+
+
+// the ring holds a frame beyond the frames of one block
+static void psl_istft_dsp(t_psl_stft *x, t_signal **sp) {
+    int n = sp[0]->s_n;
+    int size = 2 * (x->size + n);
+
+    if (size != x->ola_size) {
+        freebytes(x->ola, x->ola_size * sizeof(double));
+        x->ola = (double *)getbytes(size * sizeof(double));
+        x->ola_size = size;
+        x->rd = x->ahead = 0;
+    }
+    dsp_add(psl_istft_perform, 3, x, n, sp[0]->s_vec);
+}
+
+
+static void *psl_istft_new(t_symbol *s, int argc, t_atom *argv) {
+    t_psl_stft *x = psl_stft_alloc(psl_istft_class, argc, argv);
+    if (!x) {
+        return NULL;
+    }
+
+    x->mag = (double *)getbytes(x->bins * sizeof(double));
+    x->phase = (double *)getbytes(x->bins * sizeof(double));
+    inlet_new(&x->x_obj, &x->x_obj.ob_pd, &s_list, gensym("phase"));
+    x->out_s = outlet_new(&x->x_obj, &s_signal);
+
+    return (void *)x;
+}
+
+
+// psl class setup
+// ---------------------------------------------------------------------------
+
+
+void psl_setup(void) {
+
+    // never abort pd on a gsl error, count it instead
+    gsl_set_error_handler(psl_gsl_error);
+    gsl_rng_env_setup();
+
+    for (int i = 0; i < N_FUNCS; i++) {
+        psl_funcs[i].sym = gensym(psl_funcs[i].name);
+    }
+
+    psl_inlet_class = class_new(gensym("psl-inlet"), 
+                                0, 0, 
+                                sizeof(t_psl_inlet),
+                                CLASS_PD,
+                                0);
+
+    if (psl_inlet_class) {
+        class_addfloat(psl_inlet_class, (t_method)psl_inlet_float);
+    }
+
+    psl_class = class_new(gensym("psl"),
+                        (t_newmethod)psl_new,
+                        (t_method)psl_free,  // destructor
+                        sizeof(t_psl), 
+                        CLASS_DEFAULT, 
+                        A_GIMME, 
+                        0);
+
+    // typed methods
+    class_addbang(psl_class, psl_bang);
+    class_addfloat(psl_class, psl_float);
+    class_addlist(psl_class, psl_list);
+    class_addsymbol(psl_class, psl_symbol);
+
+    // array methods
+    class_addmethod(psl_class, (t_method)psl_apply, gensym("apply"), A_GIMME, 0);
+    class_addmethod(psl_class, (t_method)psl_map, gensym("map"), A_GIMME, 0);
+    class_addmethod(psl_class, (t_method)psl_verbose, gensym("verbose"), A_DEFFLOAT, 0);
+    class_addmethod(psl_class, (t_method)psl_precision, gensym("precision"), A_SYMBOL, 0);
+    class_addmethod(psl_class, (t_method)psl_errors, gensym("errors"), 0);
+    class_addmethod(psl_class, (t_method)psl_async, gensym("async"), A_FLOAT, 0);
+
+    // discrete hankel transform, [psl dht ...] only
+    class_addmethod(psl_class, (t_method)psl_dht, gensym("dht"), A_SYMBOL, A_DEFSYMBOL, 0);
+    class_addmethod(psl_class, (t_method)psl_dht_replan, gensym("plan"),
+        A_FLOAT, A_FLOAT, A_FLOAT, 0);
+    class_addmethod(psl_class, (t_method)psl_dht_samples, gensym("samples"),
+        A_SYMBOL, A_DEFFLOAT, 0);
+    class_addmethod(psl_class, (t_method)psl_movstat, gensym("movstat"),
+        A_SYMBOL, A_DEFSYMBOL, 0);
+    class_addmethod(psl_class, (t_method)psl_movstat_reset, gensym("reset"), 0);
+
+    // random number generator state
+    class_addmethod(psl_class, (t_method)psl_seed, gensym("seed"), A_FLOAT, 0);
+    class_addmethod(psl_class, (t_method)psl_type, gensym("type"), A_SYMBOL, 0);
+
+
+    // message methods
+
+    // class-addmethods
+    % for f in funcs + array_funcs:
+    class_addmethod(psl_class, (t_method)psl_${f.name},  gensym("${f.name}"), ${f.slots}, 0);
+    % endfor
+
+    // create alias
+    class_addcreator((t_newmethod)psl_new, gensym("gsl"), A_GIMME, 0);
+
+    // set name of default help file
+    class_sethelpsymbol(psl_class, gensym("help-psl"));
+
+
+    psl_tilde_class = class_new(gensym("psl~"),
+                        (t_newmethod)psl_tilde_new,
+                        (t_method)psl_tilde_free,
+                        sizeof(t_psl_tilde),
+                        CLASS_DEFAULT,
+                        A_GIMME,
+                        0);
+
+    CLASS_MAINSIGNALIN(psl_tilde_class, t_psl_tilde, x_f);
+    class_addmethod(psl_tilde_class, (t_method)psl_tilde_dsp, gensym("dsp"), A_CANT, 0);
+    class_addmethod(psl_tilde_class, (t_method)psl_tilde_errors, gensym("errors"), 0);
+    class_addmethod(psl_tilde_class, (t_method)psl_tilde_set, gensym("set"), A_SYMBOL, 0);
+
+    class_addcreator((t_newmethod)psl_tilde_new, gensym("gsl~"), A_GIMME, 0);
+    class_sethelpsymbol(psl_tilde_class, gensym("help-psl"));
+
+
+    psl_fft_class = class_new(gensym("psl.fft"),
+                        (t_newmethod)psl_fft_new,
+                        (t_method)psl_fft_free,
+                        sizeof(t_psl_fft),
+                        CLASS_DEFAULT,
+                        0);
+
+    class_addmethod(psl_fft_class, (t_method)psl_fft_real, gensym("real"), A_SYMBOL, 0);
+    class_addmethod(psl_fft_class, (t_method)psl_fft_inverse, gensym("inverse"), A_SYMBOL, 0);
+    class_addmethod(psl_fft_class, (t_method)psl_fft_polar, gensym("polar"),
+        A_SYMBOL, A_SYMBOL, A_DEFSYMBOL, 0);
+    class_addmethod(psl_fft_class, (t_method)psl_fft_errors, gensym("errors"), 0);
+    class_sethelpsymbol(psl_fft_class, gensym("help-psl"));
+
+
+    psl_wavelet_class = class_new(gensym("psl.wavelet"),
+                        (t_newmethod)psl_wavelet_new,
+                        (t_method)psl_wavelet_free,
+                        sizeof(t_psl_wavelet),
+                        CLASS_DEFAULT,
+                        A_GIMME,
+                        0);
+
+    class_addmethod(psl_wavelet_class, (t_method)psl_wavelet_forward, gensym("forward"), A_SYMBOL, 0);
+    class_addmethod(psl_wavelet_class, (t_method)psl_wavelet_inverse, gensym("inverse"), A_SYMBOL, 0);
+    class_addmethod(psl_wavelet_class, (t_method)psl_wavelet_forward2d, gensym("forward2d"), A_SYMBOL, 0);
+    class_addmethod(psl_wavelet_class, (t_method)psl_wavelet_inverse2d, gensym("inverse2d"), A_SYMBOL, 0);
+    class_addmethod(psl_wavelet_class, (t_method)psl_wavelet_denoise, gensym("denoise"),
+        A_SYMBOL, A_FLOAT, A_DEFSYMBOL, 0);
+    class_addmethod(psl_wavelet_class, (t_method)psl_wavelet_errors, gensym("errors"), 0);
+    class_sethelpsymbol(psl_wavelet_class, gensym("help-psl"));
+
+
+    psl_rstat_class = class_new(gensym("psl.rstat"),
+                        (t_newmethod)psl_rstat_new,
+                        (t_method)psl_rstat_free,
+                        sizeof(t_psl_rstat),
+                        CLASS_DEFAULT,
+                        A_GIMME,
+                        0);
+
+    class_addfloat(psl_rstat_class, psl_rstat_float);
+    class_addlist(psl_rstat_class, psl_rstat_list);
+    class_addbang(psl_rstat_class, psl_rstat_bang);
+    class_addmethod(psl_rstat_class, (t_method)psl_rstat_reset, gensym("reset"), 0);
+    class_sethelpsymbol(psl_rstat_class, gensym("help-psl"));
+
+
+    psl_stft_class = class_new(gensym("psl.stft~"),
+                        (t_newmethod)psl_stft_new,
+                        (t_method)psl_stft_free,
+                        sizeof(t_psl_stft),
+                        CLASS_DEFAULT,
+                        A_GIMME,
+                        0);
+
+    CLASS_MAINSIGNALIN(psl_stft_class, t_psl_stft, x_f);
+    class_addmethod(psl_stft_class, (t_method)psl_stft_dsp, gensym("dsp"), A_CANT, 0);
+    class_addmethod(psl_stft_class, (t_method)psl_stft_arrays, gensym("arrays"),
+        A_DEFSYMBOL, A_DEFSYMBOL, 0);
+    class_addmethod(psl_stft_class, (t_method)psl_stft_errors, gensym("errors"), 0);
+    class_sethelpsymbol(psl_stft_class, gensym("help-psl"));
+
+
+    psl_istft_class = class_new(gensym("psl.istft~"),
+                        (t_newmethod)psl_istft_new,
+                        (t_method)psl_stft_free,
+                        sizeof(t_psl_stft),
+                        CLASS_DEFAULT,
+                        A_GIMME,
+                        0);
+
+    class_addlist(psl_istft_class, psl_istft_list);
+    class_addbang(psl_istft_class, psl_istft_bang);
+    class_addmethod(psl_istft_class, (t_method)psl_istft_phase, gensym("phase"), A_GIMME, 0);
+    class_addmethod(psl_istft_class, (t_method)psl_istft_dsp, gensym("dsp"), A_CANT, 0);
+    class_addmethod(psl_istft_class, (t_method)psl_stft_arrays, gensym("arrays"),
+        A_DEFSYMBOL, A_DEFSYMBOL, 0);
+    class_addmethod(psl_istft_class, (t_method)psl_stft_errors, gensym("errors"), 0);
+    class_sethelpsymbol(psl_istft_class, gensym("help-psl"));
 }
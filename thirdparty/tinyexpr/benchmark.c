@@ -23,6 +23,7 @@
  */
 
 #include <stdio.h>
+#include <stdlib.h>
 #include <time.h>
 #include <math.h>
 #include "tinyexpr.h"
@@ -30,6 +31,7 @@
 
 
 #define loops 10000
+#define block 80
 
 
 
@@ -42,6 +44,8 @@ void bench(const char *expr, function1 func) {
     clock_t start;
 
     te_variable lk = {"a", &tmp};
+    double in[block], out[block], *work;
+    int k;
 
     printf("Expression: %s\n", expr);
 
@@ -88,6 +92,66 @@ void bench(const char *expr, function1 func) {
     printf("%.2f%% longer\n", (((double)eelapsed / nelapsed) - 1.0) * 100.0);
 
 
+
+
+    printf("bytecode ");
+    n = te_compile(expr, &lk, 1, 0);
+    te_program *p = te_compile_program(n);
+    te_free(n);
+    start = clock();
+    d = 0;
+    for (j = 0; j < loops; ++j)
+        for (i = 0; i < loops; ++i) {
+            tmp = i;
+            d += te_eval_program(p);
+        }
+    const int pelapsed = (clock() - start) * 1000 / CLOCKS_PER_SEC;
+    te_free_program(p);
+
+    /*Million floats per second input.*/
+    printf(" %.5g", d);
+    if (pelapsed)
+        printf("\t%5dms\t%5dmfps\n", pelapsed, loops * loops / pelapsed / 1000);
+    else
+        printf("\tinf\n");
+
+
+    printf("%.2f%% longer, %.2fx interp\n", (((double)pelapsed / nelapsed) - 1.0) * 100.0,
+            pelapsed ? (double)eelapsed / pelapsed : 0.0);
+
+
+
+
+    printf("block ");
+    n = te_compile(expr, &lk, 1, 0);
+    p = te_compile_program(n);
+    te_free(n);
+    te_program_rebind(p, &tmp, in);
+    work = malloc(sizeof(double) * te_program_workspace(p, block));
+    start = clock();
+    d = 0;
+    for (j = 0; j < loops; ++j)
+        for (i = 0; i < loops; i += block) {
+            for (k = 0; k < block; ++k) in[k] = i + k;
+            te_eval_program_block(p, block, out, work);
+            for (k = 0; k < block; ++k) d += out[k];
+        }
+    const int belapsed = (clock() - start) * 1000 / CLOCKS_PER_SEC;
+    te_free_program(p);
+    free(work);
+
+    /*Million floats per second input.*/
+    printf(" %.5g", d);
+    if (belapsed)
+        printf("\t%5dms\t%5dmfps\n", belapsed, loops * loops / belapsed / 1000);
+    else
+        printf("\tinf\n");
+
+
+    printf("%.2f%% longer, %.2fx interp\n", (((double)belapsed / nelapsed) - 1.0) * 100.0,
+            belapsed ? (double)eelapsed / belapsed : 0.0);
+
+
     printf("\n");
 }
 
@@ -545,6 +545,98 @@ void test_closure() {
     }
 }
 
+void test_program() {
+
+    double x, y, extra;
+    te_variable lookup[] = {
+        {"x", &x},
+        {"y", &y},
+        {"sum3", sum3, TE_FUNCTION3},
+        {"sum7", sum7, TE_FUNCTION7},
+        {"c0", clo0, TE_CLOSURE0, &extra},
+        {"c2", clo2, TE_CLOSURE2, &extra},
+    };
+
+    const char *cases[] = {
+        "x", "5", "-x", "x+y", "x-y", "x*y", "x/y", "x^y", "x%y",
+        "-x^2", "(x+1)*(y-1)/(x+y)", "sqrt(x^1.5+y^2.5)",
+        "1/(x+1)+2/(x+2)+3/(x+3)", "atan2(x, y) + fac(3) * abs(-y)",
+        "sum3(x, y, sum3(y, x, 1))", "sum7(x, y, 1, 2, x*y, -y, x)",
+        "c0 + c2(x, c2(y, x))", "x, y", "(x, y) + (y, x)",
+        "sin(cos(tan(x + sin(cos(tan(y + sin(cos(tan(x + y)))))))))",
+        "x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+(x+y)))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))))",
+    };
+
+    int i, j;
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        int err;
+        te_expr *ex = te_compile(cases[i], lookup, sizeof(lookup)/sizeof(te_variable), &err);
+        lok(ex);
+        te_program *p = te_compile_program(ex);
+        lok(p);
+
+        for (j = 0; j < 4; ++j) {
+            x = 0.5 + j;
+            y = 3.25 - j * 0.75;
+            extra = j;
+            lfequal(te_eval_program(p), te_eval(ex));
+        }
+
+        te_free_program(p);
+        te_free(ex);
+    }
+
+    lok(te_compile_program(0) == 0);
+}
+
+
+void test_program_block() {
+
+    enum {N = 37};
+    double x, y, extra;
+    double xs[N], ys[N], out[N], work[64 * N];
+    te_variable lookup[] = {
+        {"x", &x},
+        {"y", &y},
+        {"sum3", sum3, TE_FUNCTION3},
+        {"c2", clo2, TE_CLOSURE2, &extra},
+    };
+
+    const char *cases[] = {
+        "x", "5", "-x", "x+y", "x-y*2", "x*y/3", "x^y", "y%x", "2^x", "x+1-y",
+        "(x+1)*(y-1)/(x+y)", "sqrt(x^1.5+y^2.5)", "atan2(x, y)",
+        "sum3(x, y, sum3(y, x, 1))", "c2(x, c2(y, 3))", "x, y",
+    };
+
+    int i, j;
+    extra = 0.5;
+    for (i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+        int err;
+        te_expr *ex = te_compile(cases[i], lookup, sizeof(lookup)/sizeof(te_variable), &err);
+        lok(ex);
+        te_program *p = te_compile_program(ex);
+        lok(te_program_workspace(p, N) <= 64 * N);
+        te_program_rebind(p, &x, xs);
+        te_program_rebind(p, &y, ys);
+
+        for (j = 0; j < N; ++j) {
+            xs[j] = 0.25 + j * 0.5;
+            ys[j] = 3.25 - j * 0.05;
+        }
+        te_eval_program_block(p, N, out, work);
+
+        for (j = 0; j < N; ++j) {
+            x = xs[j];
+            y = ys[j];
+            lfequal(out[j], te_eval(ex));
+        }
+
+        te_free_program(p);
+        te_free(ex);
+    }
+}
+
+
 void test_optimize() {
 
     test_case cases[] = {
@@ -700,6 +792,8 @@ int main(int argc, char *argv[])
     lrun("Functions", test_functions);
     lrun("Dynamic", test_dynamic);
     lrun("Closure", test_closure);
+    lrun("Program", test_program);
+    lrun("Block", test_program_block);
     lrun("Optimize", test_optimize);
     lrun("Pow", test_pow);
     lrun("Combinatorics", test_combinatorics);
@@ -630,6 +630,330 @@ double te_interp(const char *expression, int *error) {
     return ret;
 }
 
+/* Flattened evaluation.
+ * te_compile_program() lowers a tree into a contiguous postfix program that
+ * te_eval_program() runs on a small value stack.  The arithmetic operators
+ * get their own opcodes so the common cases avoid an indirect call, and the
+ * whole program sits in one allocation instead of one per node. */
+
+enum {
+    TE_OP_NEG = TE_CLOSURE7+1,
+    TE_OP_ADD, TE_OP_SUB, TE_OP_MUL, TE_OP_DIV, TE_OP_POW, TE_OP_FMOD,
+    /* Same operators with a constant right operand... */
+    TE_OP_ADDK, TE_OP_SUBK, TE_OP_MULK, TE_OP_DIVK, TE_OP_POWK, TE_OP_FMODK,
+    /* ...and with a bound variable. */
+    TE_OP_ADDV, TE_OP_SUBV, TE_OP_MULV, TE_OP_DIVV, TE_OP_POWV, TE_OP_FMODV
+};
+
+#define TE_OP_BINARY (TE_OP_FMOD - TE_OP_ADD + 1)
+#define IS_LEAF(n) ((n)->type == TE_CONSTANT || (n)->type == TE_VARIABLE)
+
+#define TE_PROGRAM_STACK 64
+
+typedef struct te_op {
+    int code;
+    union {double value; const double *bound; const void *function;};
+    void *context;
+} te_op;
+
+struct te_program {
+    int count;
+    int depth;
+    te_op ops[1];
+};
+
+
+/* Upper bound on the program length; fused operands only shrink it. */
+static int op_count(const te_expr *n) {
+    const int arity = ARITY(n->type);
+    int i, count = 1;
+    for (i = 0; i < arity; ++i) count += op_count(n->parameters[i]);
+    return count;
+}
+
+
+static int op_code(const te_expr *n) {
+    const int type = TYPE_MASK(n->type);
+    if (type == TE_FUNCTION2 || type == TE_FUNCTION1) {
+        if (n->function == add) return TE_OP_ADD;
+        if (n->function == sub) return TE_OP_SUB;
+        if (n->function == mul) return TE_OP_MUL;
+        if (n->function == divide) return TE_OP_DIV;
+        if (n->function == negate) return TE_OP_NEG;
+        if (n->function == pow) return TE_OP_POW;
+        if (n->function == fmod) return TE_OP_FMOD;
+    }
+    return type;
+}
+
+
+/* Emits n in postfix order; returns the stack depth needed to evaluate it.
+ * A binary operator whose right operand is a leaf is fused with it, and the
+ * operands of + and * are swapped to get there when only the left one is. */
+static int emit(const te_expr *n, te_op **op, int sp) {
+    const int code = op_code(n);
+    const int arity = ARITY(n->type);
+    int i, depth = sp + 1;
+
+    if (code >= TE_OP_ADD && code <= TE_OP_FMOD) {
+        const te_expr *l = n->parameters[0], *r = n->parameters[1];
+        if (!IS_LEAF(r) && IS_LEAF(l) && (code == TE_OP_ADD || code == TE_OP_MUL)) {
+            const te_expr *t = l; l = r; r = t;
+        }
+        if (IS_LEAF(r)) {
+            const int d = emit(l, op, sp);
+            if (d > depth) depth = d;
+            if (r->type == TE_CONSTANT) {
+                (*op)->code = code + TE_OP_BINARY;
+                (*op)->value = r->value;
+            } else {
+                (*op)->code = code + 2 * TE_OP_BINARY;
+                (*op)->bound = r->bound;
+            }
+            (*op)->context = 0;
+            ++*op;
+            return depth;
+        }
+    }
+
+    for (i = 0; i < arity; ++i) {
+        const int d = emit(n->parameters[i], op, sp + i);
+        if (d > depth) depth = d;
+    }
+    (*op)->code = code;
+    (*op)->function = n->function;
+    (*op)->context = IS_CLOSURE(n->type) ? n->parameters[arity] : 0;
+    if (n->type == TE_CONSTANT) (*op)->value = n->value;
+    ++*op;
+    return depth;
+}
+
+
+te_program *te_compile_program(const te_expr *n) {
+    if (!n) return 0;
+    const int count = op_count(n);
+    te_program *p = malloc(sizeof(te_program) + sizeof(te_op) * (count - 1));
+    if (!p) return 0;
+    te_op *op = p->ops;
+    p->depth = emit(n, &op, 0);
+    p->count = op - p->ops;
+    return p;
+}
+
+
+#define TE_FUN(...) ((double(*)(__VA_ARGS__))op->function)
+#define A(e) s[e]
+
+static double run(const te_program *p, double *stack) {
+    const te_op *op = p->ops;
+    const te_op *end = op + p->count;
+    double *sp = stack;
+    double *s;
+
+    for (; op < end; ++op) {
+        switch (op->code) {
+            case TE_CONSTANT: *sp++ = op->value; break;
+            case TE_VARIABLE: *sp++ = *op->bound; break;
+
+            case TE_OP_ADD: sp[-2] += sp[-1]; --sp; break;
+            case TE_OP_SUB: sp[-2] -= sp[-1]; --sp; break;
+            case TE_OP_MUL: sp[-2] *= sp[-1]; --sp; break;
+            case TE_OP_DIV: sp[-2] /= sp[-1]; --sp; break;
+            case TE_OP_NEG: sp[-1] = -sp[-1]; break;
+            case TE_OP_POW: sp[-2] = pow(sp[-2], sp[-1]); --sp; break;
+            case TE_OP_FMOD: sp[-2] = fmod(sp[-2], sp[-1]); --sp; break;
+
+            case TE_OP_ADDK: sp[-1] += op->value; break;
+            case TE_OP_SUBK: sp[-1] -= op->value; break;
+            case TE_OP_MULK: sp[-1] *= op->value; break;
+            case TE_OP_DIVK: sp[-1] /= op->value; break;
+            case TE_OP_POWK: sp[-1] = pow(sp[-1], op->value); break;
+            case TE_OP_FMODK: sp[-1] = fmod(sp[-1], op->value); break;
+
+            case TE_OP_ADDV: sp[-1] += *op->bound; break;
+            case TE_OP_SUBV: sp[-1] -= *op->bound; break;
+            case TE_OP_MULV: sp[-1] *= *op->bound; break;
+            case TE_OP_DIVV: sp[-1] /= *op->bound; break;
+            case TE_OP_POWV: sp[-1] = pow(sp[-1], *op->bound); break;
+            case TE_OP_FMODV: sp[-1] = fmod(sp[-1], *op->bound); break;
+
+            case TE_FUNCTION0: *sp++ = TE_FUN(void)(); break;
+            case TE_FUNCTION1: s = sp - 1; s[0] = TE_FUN(double)(A(0)); break;
+            case TE_FUNCTION2: s = sp - 2; s[0] = TE_FUN(double, double)(A(0), A(1)); sp = s + 1; break;
+            case TE_FUNCTION3: s = sp - 3; s[0] = TE_FUN(double, double, double)(A(0), A(1), A(2)); sp = s + 1; break;
+            case TE_FUNCTION4: s = sp - 4; s[0] = TE_FUN(double, double, double, double)(A(0), A(1), A(2), A(3)); sp = s + 1; break;
+            case TE_FUNCTION5: s = sp - 5; s[0] = TE_FUN(double, double, double, double, double)(A(0), A(1), A(2), A(3), A(4)); sp = s + 1; break;
+            case TE_FUNCTION6: s = sp - 6; s[0] = TE_FUN(double, double, double, double, double, double)(A(0), A(1), A(2), A(3), A(4), A(5)); sp = s + 1; break;
+            case TE_FUNCTION7: s = sp - 7; s[0] = TE_FUN(double, double, double, double, double, double, double)(A(0), A(1), A(2), A(3), A(4), A(5), A(6)); sp = s + 1; break;
+
+            case TE_CLOSURE0: *sp++ = TE_FUN(void*)(op->context); break;
+            case TE_CLOSURE1: s = sp - 1; s[0] = TE_FUN(void*, double)(op->context, A(0)); break;
+            case TE_CLOSURE2: s = sp - 2; s[0] = TE_FUN(void*, double, double)(op->context, A(0), A(1)); sp = s + 1; break;
+            case TE_CLOSURE3: s = sp - 3; s[0] = TE_FUN(void*, double, double, double)(op->context, A(0), A(1), A(2)); sp = s + 1; break;
+            case TE_CLOSURE4: s = sp - 4; s[0] = TE_FUN(void*, double, double, double, double)(op->context, A(0), A(1), A(2), A(3)); sp = s + 1; break;
+            case TE_CLOSURE5: s = sp - 5; s[0] = TE_FUN(void*, double, double, double, double, double)(op->context, A(0), A(1), A(2), A(3), A(4)); sp = s + 1; break;
+            case TE_CLOSURE6: s = sp - 6; s[0] = TE_FUN(void*, double, double, double, double, double, double)(op->context, A(0), A(1), A(2), A(3), A(4), A(5)); sp = s + 1; break;
+            case TE_CLOSURE7: s = sp - 7; s[0] = TE_FUN(void*, double, double, double, double, double, double, double)(op->context, A(0), A(1), A(2), A(3), A(4), A(5), A(6)); sp = s + 1; break;
+
+            default: return NAN;
+        }
+    }
+
+    return stack[0];
+}
+
+#undef TE_FUN
+#undef A
+
+
+double te_eval_program(const te_program *p) {
+    if (!p) return NAN;
+    if (p->depth <= TE_PROGRAM_STACK) {
+        double stack[TE_PROGRAM_STACK];
+        return run(p, stack);
+    } else {
+        double *stack = malloc(sizeof(double) * p->depth);
+        double ret = stack ? run(p, stack) : NAN;
+        free(stack);
+        return ret;
+    }
+}
+
+
+void te_free_program(te_program *p) {
+    free(p);
+}
+
+
+/* Block evaluation.
+ * Runs the program once over n samples: every op is a loop over the block,
+ * so dispatch is paid once per op instead of once per sample and the
+ * arithmetic loops are left to the auto-vectorizer.  Each variable is read
+ * as n consecutive values starting at its bound address. */
+
+int te_program_workspace(const te_program *p, int n) {
+    if (!p || p->depth < 1) return 0;
+    return (p->depth - 1) * n;
+}
+
+
+int te_program_rebind(te_program *p, const double *from, const double *to) {
+    int i, count = 0;
+    if (!p) return 0;
+    for (i = 0; i < p->count; ++i) {
+        te_op *op = &p->ops[i];
+        const int code = op->code;
+        if ((code == TE_VARIABLE || (code >= TE_OP_ADDV && code <= TE_OP_FMODV)) && op->bound == from) {
+            op->bound = to;
+            ++count;
+        }
+    }
+    return count;
+}
+
+
+#define TE_FUN(...) ((double(*)(__VA_ARGS__))op->function)
+#define SLOT(k) ((k) ? work + ((k) - 1) * n : out)
+#define LOOP(body) for (i = 0; i < n; ++i) {body;} break
+
+void te_eval_program_block(const te_program *p, int n, double *out, double *work) {
+    const te_op *op, *end;
+    int i, sp = 0;
+
+    if (!p) {
+        for (i = 0; i < n; ++i) out[i] = NAN;
+        return;
+    }
+
+    for (op = p->ops, end = op + p->count; op < end; ++op) {
+        const int code = op->code;
+
+        if (code == TE_CONSTANT) {
+            double *restrict r = SLOT(sp);
+            const double k = op->value;
+            ++sp;
+            for (i = 0; i < n; ++i) r[i] = k;
+        } else if (code == TE_VARIABLE) {
+            memcpy(SLOT(sp), op->bound, sizeof(double) * n);
+            ++sp;
+        } else if (code >= TE_OP_ADD && code <= TE_OP_FMOD) {
+            double *restrict a = SLOT(sp - 2);
+            const double *restrict b = SLOT(sp - 1);
+            --sp;
+            switch (code) {
+                case TE_OP_ADD: LOOP(a[i] += b[i]);
+                case TE_OP_SUB: LOOP(a[i] -= b[i]);
+                case TE_OP_MUL: LOOP(a[i] *= b[i]);
+                case TE_OP_DIV: LOOP(a[i] /= b[i]);
+                case TE_OP_POW: LOOP(a[i] = pow(a[i], b[i]));
+                case TE_OP_FMOD: LOOP(a[i] = fmod(a[i], b[i]));
+            }
+        } else if (code >= TE_OP_ADDK && code <= TE_OP_FMODK) {
+            double *restrict a = SLOT(sp - 1);
+            const double k = op->value;
+            switch (code) {
+                case TE_OP_ADDK: LOOP(a[i] += k);
+                case TE_OP_SUBK: LOOP(a[i] -= k);
+                case TE_OP_MULK: LOOP(a[i] *= k);
+                case TE_OP_DIVK: LOOP(a[i] /= k);
+                case TE_OP_POWK: LOOP(a[i] = pow(a[i], k));
+                case TE_OP_FMODK: LOOP(a[i] = fmod(a[i], k));
+            }
+        } else if (code >= TE_OP_ADDV && code <= TE_OP_FMODV) {
+            double *restrict a = SLOT(sp - 1);
+            const double *restrict b = op->bound;
+            switch (code) {
+                case TE_OP_ADDV: LOOP(a[i] += b[i]);
+                case TE_OP_SUBV: LOOP(a[i] -= b[i]);
+                case TE_OP_MULV: LOOP(a[i] *= b[i]);
+                case TE_OP_DIVV: LOOP(a[i] /= b[i]);
+                case TE_OP_POWV: LOOP(a[i] = pow(a[i], b[i]));
+                case TE_OP_FMODV: LOOP(a[i] = fmod(a[i], b[i]));
+            }
+        } else if (code == TE_OP_NEG) {
+            double *restrict a = SLOT(sp - 1);
+            for (i = 0; i < n; ++i) a[i] = -a[i];
+        } else if (code >= TE_FUNCTION0 && code <= TE_CLOSURE7) {
+            const int arity = ARITY(code);
+            double *s[7];
+            double *r;
+            void *c = op->context;
+            int j;
+            sp -= arity;
+            for (j = 0; j < arity; ++j) s[j] = SLOT(sp + j);
+            r = SLOT(sp);
+            ++sp;
+            switch (code) {
+                case TE_FUNCTION0: LOOP(r[i] = TE_FUN(void)());
+                case TE_FUNCTION1: LOOP(r[i] = TE_FUN(double)(s[0][i]));
+                case TE_FUNCTION2: LOOP(r[i] = TE_FUN(double, double)(s[0][i], s[1][i]));
+                case TE_FUNCTION3: LOOP(r[i] = TE_FUN(double, double, double)(s[0][i], s[1][i], s[2][i]));
+                case TE_FUNCTION4: LOOP(r[i] = TE_FUN(double, double, double, double)(s[0][i], s[1][i], s[2][i], s[3][i]));
+                case TE_FUNCTION5: LOOP(r[i] = TE_FUN(double, double, double, double, double)(s[0][i], s[1][i], s[2][i], s[3][i], s[4][i]));
+                case TE_FUNCTION6: LOOP(r[i] = TE_FUN(double, double, double, double, double, double)(s[0][i], s[1][i], s[2][i], s[3][i], s[4][i], s[5][i]));
+                case TE_FUNCTION7: LOOP(r[i] = TE_FUN(double, double, double, double, double, double, double)(s[0][i], s[1][i], s[2][i], s[3][i], s[4][i], s[5][i], s[6][i]));
+
+                case TE_CLOSURE0: LOOP(r[i] = TE_FUN(void*)(c));
+                case TE_CLOSURE1: LOOP(r[i] = TE_FUN(void*, double)(c, s[0][i]));
+                case TE_CLOSURE2: LOOP(r[i] = TE_FUN(void*, double, double)(c, s[0][i], s[1][i]));
+                case TE_CLOSURE3: LOOP(r[i] = TE_FUN(void*, double, double, double)(c, s[0][i], s[1][i], s[2][i]));
+                case TE_CLOSURE4: LOOP(r[i] = TE_FUN(void*, double, double, double, double)(c, s[0][i], s[1][i], s[2][i], s[3][i]));
+                case TE_CLOSURE5: LOOP(r[i] = TE_FUN(void*, double, double, double, double, double)(c, s[0][i], s[1][i], s[2][i], s[3][i], s[4][i]));
+                case TE_CLOSURE6: LOOP(r[i] = TE_FUN(void*, double, double, double, double, double, double)(c, s[0][i], s[1][i], s[2][i], s[3][i], s[4][i], s[5][i]));
+                case TE_CLOSURE7: LOOP(r[i] = TE_FUN(void*, double, double, double, double, double, double, double)(c, s[0][i], s[1][i], s[2][i], s[3][i], s[4][i], s[5][i], s[6][i]));
+            }
+        } else {
+            for (i = 0; i < n; ++i) out[i] = NAN;
+            return;
+        }
+    }
+}
+
+#undef TE_FUN
+#undef SLOT
+#undef LOOP
+
+
 static void pn (const te_expr *n, int depth) {
     int i, arity;
     printf("%*s", depth, "");